@@ -91,6 +91,13 @@ void Statement::bind(const int aIndex) // throw(SQLite::Exception)
     check(ret);
 }
 
+// Bind a text value of the given size to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement, without copying it
+void Statement::bindNoCopy(const int aIndex, const char* apValue, const int aSize) // throw(SQLite::Exception)
+{
+    int ret = sqlite3_bind_text(mStmtPtr, aIndex, apValue, aSize, SQLITE_STATIC);
+    check(ret);
+}
+
 
 // Bind an int value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
 void Statement::bind(const char* apName, const int& aValue) // throw(SQLite::Exception)
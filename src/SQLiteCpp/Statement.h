@@ -105,6 +105,12 @@ public:
      * @brief Bind a NULL value to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1)
      */
     void bind(const int aIndex); // throw(SQLite::Exception);
+    /**
+     * @brief Bind a text value of the given size to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1)
+     *
+     * @note This uses the SQLITE_STATIC flag, so the data is not copied and must remain valid until the statement is reset
+     */
+    void bindNoCopy(const int aIndex, const char* apValue, const int aSize); // throw(SQLite::Exception);
 
     /**
      * @brief Bind an int value to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1)
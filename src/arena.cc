@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "arena.hh"
+
+const gsize Arena::INITIAL_BLOCK_SIZE = 4 * 1024;
+const gsize Arena::BLOCK_SIZE = 1024 * 1024;
+
+Arena::Arena() :
+	_block_size(Arena::INITIAL_BLOCK_SIZE),
+	_position(nullptr),
+	_available(0)
+{ }
+
+Arena::Arena(const std::shared_ptr<const void> & source) :
+	_sources(1, source),
+	_block_size(Arena::INITIAL_BLOCK_SIZE),
+	_position(nullptr),
+	_available(0)
+{ }
+
+void * Arena::allocate(gsize size, gsize alignment)
+{
+	if (size + alignment > Arena::BLOCK_SIZE / 4)
+	{
+		this->_blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+		return this->_blocks.back().get();
+	}
+
+	gsize padding = (alignment - reinterpret_cast<guintptr>(this->_position) % alignment) % alignment;
+
+	if (size + padding > this->_available)
+	{
+		const gsize block_size = std::max(this->_block_size, size + alignment);
+
+		this->_blocks.push_back(std::unique_ptr<char[]>(new char[block_size]));
+		this->_position = this->_blocks.back().get();
+		this->_available = block_size;
+		this->_block_size = std::min(this->_block_size * 2, Arena::BLOCK_SIZE);
+
+		padding = 0;
+	}
+
+	char * result = this->_position + padding;
+
+	this->_position += size + padding;
+	this->_available -= size + padding;
+
+	return result;
+}
+
+const char * Arena::copy(const char * data, gsize length)
+{
+	if (length == 0)
+		return "";
+
+	char * result = static_cast<char *>(this->allocate(length, 1));
+	memcpy(result, data, length);
+
+	return result;
+}
+
+void Arena::retain(const std::shared_ptr<const void> & source)
+{
+	this->_sources.push_back(source);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHATSTATS_ARENA_HH
+#define CHATSTATS_ARENA_HH
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <glib.h>
+
+class Arena
+{
+	public:
+		const static gsize INITIAL_BLOCK_SIZE;
+		const static gsize BLOCK_SIZE;
+
+		Arena();
+		Arena(const std::shared_ptr<const void> & source);
+
+		Arena(const Arena &) = delete;
+		Arena & operator=(const Arena &) = delete;
+
+		void * allocate(gsize size, gsize alignment);
+		const char * copy(const char * data, gsize length);
+
+		void retain(const std::shared_ptr<const void> & source);
+
+	private:
+		std::vector<std::shared_ptr<const void>> _sources;
+		std::vector<std::unique_ptr<char[]>> _blocks;
+		gsize _block_size;
+
+		char * _position;
+		gsize _available;
+};
+
+template <class T>
+class ArenaAllocator : public std::allocator<T>
+{
+	public:
+		template <class U>
+		struct rebind
+		{
+			typedef ArenaAllocator<U> other;
+		};
+
+		ArenaAllocator(Arena * arena = nullptr) :
+			_arena(arena)
+		{ }
+
+		template <class U>
+		ArenaAllocator(const ArenaAllocator<U> & other) :
+			_arena(other.get_arena())
+		{ }
+
+		T * allocate(std::size_t count, const void * = nullptr)
+		{
+			if (this->_arena)
+				return static_cast<T *>(this->_arena->allocate(count * sizeof(T), alignof(T)));
+
+			return static_cast<T *>(::operator new(count * sizeof(T)));
+		}
+
+		void deallocate(T * pointer, std::size_t)
+		{
+			if (!this->_arena)
+				::operator delete(pointer);
+		}
+
+		Arena * get_arena() const
+		{
+			return this->_arena;
+		}
+
+	private:
+		Arena * _arena;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b)
+{
+	return a.get_arena() == b.get_arena();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b)
+{
+	return a.get_arena() != b.get_arena();
+}
+
+#endif // CHATSTATS_ARENA_HH
@@ -54,11 +54,17 @@ int main(int argc, char **argv)
 	Gio::init();
 
 	Glib::ustring input_format = "chatstats";
+	Glib::ustring output_format = "chatstats";
 	Glib::ustring users_filename = "";
+	Glib::ustring cache_directory_name = "";
+	Glib::ustring warnings = "summary";
+	std::string database_filename = "";
 
 	bool debug = false;
 	bool separate_userhosts = false;
 
+	int jobs = 1;
+
 	Glib::OptionGroup option_group("options", "Options", "Options to configure program");
 	Glib::OptionEntry debug_entry = create_option_entry("debug", 'd', "Output additional debug information");
 	option_group.add_entry(debug_entry, debug);
@@ -69,9 +75,24 @@ int main(int argc, char **argv)
 	Glib::OptionEntry input_format_entry = create_option_entry("input-format", 'f', "Format of logs in input directory");
 	option_group.add_entry(input_format_entry, input_format);
 
+	Glib::OptionEntry output_format_entry = create_option_entry("output-format", 'o', "Format of logs written by the convert command");
+	option_group.add_entry(output_format_entry, output_format);
+
 	Glib::OptionEntry users_file_entry = create_option_entry("users-file", 'u', "User configuration file");
 	option_group.add_entry(users_file_entry, users_filename);
 
+	Glib::OptionEntry jobs_entry = create_option_entry("jobs", 'j', "Number of log files to parse in parallel");
+	option_group.add_entry(jobs_entry, jobs);
+
+	Glib::OptionEntry cache_directory_entry = create_option_entry("cache-directory", 'c', "Directory to cache parsed log files in");
+	option_group.add_entry(cache_directory_entry, cache_directory_name);
+
+	Glib::OptionEntry warnings_entry = create_option_entry("warnings", 'w', "How to report warnings (full, summary or none)");
+	option_group.add_entry(warnings_entry, warnings);
+
+	Glib::OptionEntry database_entry = create_option_entry("database", 'D', "Database to keep generated statistics in between runs");
+	option_group.add_entry_filename(database_entry, database_filename);
+
 	Glib::OptionContext option_context("[COMMAND] [COMMAND-PARAMETERS]...");
 	option_context.set_main_group(option_group);
 	option_context.set_summary("Commands:\n  convert [INPUT-DIRECTORY] [OUTPUT-DIRECTORY]\n  count [INPUT-DIRECTORY]\n  coverage [INPUT-DIRECTORY]\n  frequency [INPUT-DIRECTORY] [TARGET]\n  generate [INPUT-DIRECTORY] [OUTPUT-DIRECTORY]");
@@ -91,12 +112,46 @@ int main(int argc, char **argv)
 		log_reader = std::make_shared<ChatstatsLogReader>();
 	else if (input_format == "mirc")
 		log_reader = std::make_shared<MircLogReader>();
+	else if (input_format == "binary")
+		log_reader = std::make_shared<BinaryLogReader>();
 	else
 	{
 		std::cerr << "Invalid log format: " << input_format << std::endl;
 		exit(EXIT_FAILURE);
 	}
 
+	if (jobs < 1)
+	{
+		std::cerr << "Invalid number of jobs: " << jobs << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	WarningMode warning_mode;
+
+	if (warnings == "full")
+		warning_mode = WarningMode::FULL;
+	else if (warnings == "summary")
+		warning_mode = WarningMode::SUMMARY;
+	else if (warnings == "none")
+		warning_mode = WarningMode::NONE;
+	else
+	{
+		std::cerr << "Invalid warning mode: " << warnings << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	std::shared_ptr<const ParseCache> parse_cache = nullptr;
+
+	if (!cache_directory_name.empty())
+	{
+		Glib::RefPtr<Gio::File> cache_directory = Gio::File::create_for_commandline_arg(cache_directory_name);
+
+		if (!cache_directory->query_exists())
+			cache_directory->make_directory_with_parents();
+
+		parse_cache = std::make_shared<const ParseCache>(cache_directory, input_format);
+	}
+
 	Glib::ustring command(argv[1]);
 
 	if (command == "convert")
@@ -107,6 +162,18 @@ int main(int argc, char **argv)
 			exit(EXIT_FAILURE);
 		}
 
+		std::shared_ptr<LogWriter> log_writer = nullptr;
+
+		if (output_format == "chatstats")
+			log_writer = std::make_shared<ChatstatsLogWriter>();
+		else if (output_format == "binary")
+			log_writer = std::make_shared<BinaryLogWriter>();
+		else
+		{
+			std::cerr << "Invalid log format: " << output_format << std::endl;
+			exit(EXIT_FAILURE);
+		}
+
 		Glib::RefPtr<Gio::File> output_directory = Gio::File::create_for_commandline_arg(argv[3]);
 
 		if (output_directory->query_exists())
@@ -117,17 +184,26 @@ int main(int argc, char **argv)
 
 		output_directory->make_directory();
 
-		ConvertOperation operation(input_directory, log_reader, output_directory);
+		ConvertOperation operation(input_directory, log_reader, output_directory, log_writer);
+		operation.set_jobs(jobs);
+		operation.set_parse_cache(parse_cache);
+		operation.set_warning_mode(warning_mode);
 		operation.execute();
 	}
 	else if (command == "count")
 	{
 		CountOperation operation(input_directory, log_reader);
+		operation.set_jobs(jobs);
+		operation.set_parse_cache(parse_cache);
+		operation.set_warning_mode(warning_mode);
 		operation.execute();
 	}
 	else if (command == "coverage")
 	{
 		CoverageOperation operation(input_directory, log_reader);
+		operation.set_jobs(jobs);
+		operation.set_parse_cache(parse_cache);
+		operation.set_warning_mode(warning_mode);
 		operation.execute();
 	}
 	else if (command == "frequency")
@@ -141,6 +217,9 @@ int main(int argc, char **argv)
 		double target = Glib::Ascii::strtod(argv[3]);
 
 		FrequencyOperation operation(input_directory, log_reader, target);
+		operation.set_jobs(jobs);
+		operation.set_parse_cache(parse_cache);
+		operation.set_warning_mode(warning_mode);
 		operation.execute();
 	}
 	else if (command == "generate")
@@ -166,7 +245,10 @@ int main(int argc, char **argv)
 
 		output_directory->make_directory();
 
-		GenerateOperation operation(input_directory, log_reader, output_directory, users_file, debug, separate_userhosts);
+		GenerateOperation operation(input_directory, log_reader, output_directory, users_file, debug, separate_userhosts, database_filename);
+		operation.set_jobs(jobs);
+		operation.set_parse_cache(parse_cache);
+		operation.set_warning_mode(warning_mode);
 		operation.execute();
 	}
 	else
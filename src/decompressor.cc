@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include <lzma.h>
+#include <zlib.h>
+
+#include "decompressor.hh"
+
+const gsize Decompressor::BLOCK_SIZE = 1024 * 1024;
+const size_t Decompressor::QUEUE_LENGTH = 16;
+
+CompressionFormat Decompressor::detect_format(const char * data, gsize length)
+{
+	if (length >= 2 && memcmp(data, "\x1f\x8b", 2) == 0)
+		return CompressionFormat::GZIP;
+
+	if (length >= 6 && memcmp(data, "\xfd" "7zXZ\0", 6) == 0)
+		return CompressionFormat::XZ;
+
+	return CompressionFormat::NONE;
+}
+
+Decompressor::Decompressor(const std::shared_ptr<const void> & owner, const char * data, gsize length, CompressionFormat format) :
+	_owner(owner),
+	_data(data),
+	_length(length),
+	_format(format),
+	_finished(false),
+	_stopped(false),
+	_thread(&Decompressor::_run, this)
+{ }
+
+Decompressor::~Decompressor()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_stopped = true;
+	}
+
+	this->_condition.notify_all();
+	this->_thread.join();
+}
+
+std::shared_ptr<const std::string> Decompressor::next_block()
+{
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_condition.wait(lock, [this]() { return !this->_blocks.empty() || this->_finished; });
+
+	if (this->_blocks.empty())
+	{
+		if (this->_error)
+			std::rethrow_exception(this->_error);
+
+		return nullptr;
+	}
+
+	auto block = this->_blocks.front();
+	this->_blocks.pop_front();
+
+	lock.unlock();
+	this->_condition.notify_all();
+
+	return block;
+}
+
+void Decompressor::_run()
+{
+	try
+	{
+		if (this->_format == CompressionFormat::GZIP)
+			this->_run_gzip();
+		else if (this->_format == CompressionFormat::XZ)
+			this->_run_xz();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_error = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_finished = true;
+	}
+
+	this->_condition.notify_all();
+}
+
+void Decompressor::_run_gzip()
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+
+	if (inflateInit2(&stream, 15 + 32) != Z_OK)
+		throw std::runtime_error("Unable to initialize gzip decompression");
+
+	const Bytef * input = reinterpret_cast<const Bytef *>(this->_data);
+	gsize remaining = this->_length;
+	int result = Z_OK;
+
+	try
+	{
+		while (true)
+		{
+			auto block = std::make_shared<std::string>(Decompressor::BLOCK_SIZE, '\0');
+
+			stream.next_out = reinterpret_cast<Bytef *>(&(*block)[0]);
+			stream.avail_out = block->size();
+
+			while (stream.avail_out > 0)
+			{
+				if (stream.avail_in == 0 && remaining > 0)
+				{
+					stream.next_in = const_cast<Bytef *>(input);
+					stream.avail_in = std::min<gsize>(remaining, UINT_MAX);
+
+					input += stream.avail_in;
+					remaining -= stream.avail_in;
+				}
+
+				result = inflate(&stream, Z_NO_FLUSH);
+
+				if (result == Z_STREAM_END)
+				{
+					if (stream.avail_in == 0 && remaining == 0)
+						break;
+
+					inflateReset(&stream);
+					result = Z_OK;
+				}
+				else if (result != Z_OK)
+				{
+					throw std::runtime_error("Corrupt or truncated gzip data");
+				}
+			}
+
+			block->resize(block->size() - stream.avail_out);
+
+			if (!this->_push_block(block) || (result == Z_STREAM_END && stream.avail_in == 0 && remaining == 0))
+				break;
+		}
+	}
+	catch (...)
+	{
+		inflateEnd(&stream);
+		throw;
+	}
+
+	inflateEnd(&stream);
+}
+
+void Decompressor::_run_xz()
+{
+	lzma_stream stream = LZMA_STREAM_INIT;
+
+	if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+		throw std::runtime_error("Unable to initialize xz decompression");
+
+	stream.next_in = reinterpret_cast<const uint8_t *>(this->_data);
+	stream.avail_in = this->_length;
+
+	lzma_ret result = LZMA_OK;
+
+	try
+	{
+		while (result != LZMA_STREAM_END)
+		{
+			auto block = std::make_shared<std::string>(Decompressor::BLOCK_SIZE, '\0');
+
+			stream.next_out = reinterpret_cast<uint8_t *>(&(*block)[0]);
+			stream.avail_out = block->size();
+
+			while (stream.avail_out > 0 && result != LZMA_STREAM_END)
+			{
+				result = lzma_code(&stream, LZMA_FINISH);
+
+				if (result != LZMA_OK && result != LZMA_STREAM_END)
+					throw std::runtime_error("Corrupt or truncated xz data");
+			}
+
+			block->resize(block->size() - stream.avail_out);
+
+			if (!this->_push_block(block))
+				break;
+		}
+	}
+	catch (...)
+	{
+		lzma_end(&stream);
+		throw;
+	}
+
+	lzma_end(&stream);
+}
+
+bool Decompressor::_push_block(const std::shared_ptr<std::string> & block)
+{
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_condition.wait(lock, [this]() { return this->_stopped || this->_blocks.size() < Decompressor::QUEUE_LENGTH; });
+
+	if (this->_stopped)
+		return false;
+
+	this->_blocks.push_back(block);
+
+	lock.unlock();
+	this->_condition.notify_all();
+
+	return true;
+}
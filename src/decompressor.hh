@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_DECOMPRESSOR_HH
+#define CHATSTATS_DECOMPRESSOR_HH
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <glib.h>
+
+enum class CompressionFormat
+{
+	NONE,
+	GZIP,
+	XZ
+};
+
+class Decompressor
+{
+	public:
+		const static gsize BLOCK_SIZE;
+		const static size_t QUEUE_LENGTH;
+
+		static CompressionFormat detect_format(const char * data, gsize length);
+
+		Decompressor(const std::shared_ptr<const void> & owner, const char * data, gsize length, CompressionFormat format);
+		~Decompressor();
+
+		Decompressor(const Decompressor &) = delete;
+		Decompressor & operator=(const Decompressor &) = delete;
+
+		std::shared_ptr<const std::string> next_block();
+
+	private:
+		void _run();
+		void _run_gzip();
+		void _run_xz();
+
+		bool _push_block(const std::shared_ptr<std::string> & block);
+
+		const std::shared_ptr<const void> _owner;
+		const char * const _data;
+		const gsize _length;
+		const CompressionFormat _format;
+
+		std::deque<std::shared_ptr<const std::string>> _blocks;
+		std::exception_ptr _error;
+		bool _finished;
+		bool _stopped;
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::thread _thread;
+};
+
+#endif // CHATSTATS_DECOMPRESSOR_HH
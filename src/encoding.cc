@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "encoding.hh"
+
+const gunichar CP1252_HIGH_CODE_POINTS[] = {
+	0x20AC, 0, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0, 0x017D, 0,
+	0, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0, 0x017E, 0x0178
+};
+
+gsize _skip_ascii(const unsigned char * data, gsize length)
+{
+	gsize i = 0;
+
+#ifdef __SSE2__
+	for (; i + 16 <= length; i += 16)
+	{
+		if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i))) != 0)
+			break;
+	}
+#else
+	for (; i + 8 <= length; i += 8)
+	{
+		guint64 word;
+		memcpy(&word, data + i, 8);
+
+		if (word & G_GUINT64_CONSTANT(0x8080808080808080))
+			break;
+	}
+#endif
+
+	while (i < length && data[i] < 0x80)
+		i++;
+
+	return i;
+}
+
+bool is_valid_utf8(const char * data, gsize length)
+{
+	const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data);
+	gsize i = 0;
+
+	while (true)
+	{
+		i += _skip_ascii(bytes + i, length - i);
+
+		if (i == length)
+			return true;
+
+		const unsigned char lead = bytes[i];
+		gsize continuation_count;
+		unsigned char minimum = 0x80;
+		unsigned char maximum = 0xBF;
+
+		if (lead >= 0xC2 && lead <= 0xDF)
+		{
+			continuation_count = 1;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			continuation_count = 2;
+
+			if (lead == 0xE0)
+				minimum = 0xA0;
+			else if (lead == 0xED)
+				maximum = 0x9F;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			continuation_count = 3;
+
+			if (lead == 0xF0)
+				minimum = 0x90;
+			else if (lead == 0xF4)
+				maximum = 0x8F;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (length - i <= continuation_count)
+			return false;
+
+		if (bytes[i + 1] < minimum || bytes[i + 1] > maximum)
+			return false;
+
+		for (gsize j = 2; j <= continuation_count; j++)
+			if (bytes[i + j] < 0x80 || bytes[i + j] > 0xBF)
+				return false;
+
+		i += continuation_count + 1;
+	}
+}
+
+void _append_code_point(std::string & output, gunichar code_point)
+{
+	if (code_point < 0x80)
+	{
+		output += static_cast<char>(code_point);
+	}
+	else if (code_point < 0x800)
+	{
+		output += static_cast<char>(0xC0 | (code_point >> 6));
+		output += static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+	else
+	{
+		output += static_cast<char>(0xE0 | (code_point >> 12));
+		output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+		output += static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+}
+
+bool append_cp1252_as_utf8(std::string & output, const char * data, gsize length)
+{
+	const gsize original_size = output.size();
+	const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data);
+
+	output.reserve(original_size + length * 3);
+
+	for (gsize i = 0; i < length; i++)
+	{
+		gunichar code_point = bytes[i];
+
+		if (code_point >= 0x80 && code_point < 0xA0)
+		{
+			code_point = CP1252_HIGH_CODE_POINTS[code_point - 0x80];
+
+			if (code_point == 0)
+			{
+				output.resize(original_size);
+				return false;
+			}
+		}
+
+		_append_code_point(output, code_point);
+	}
+
+	return true;
+}
+
+void append_latin1_as_utf8(std::string & output, const char * data, gsize length)
+{
+	const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data);
+
+	output.reserve(output.size() + length * 2);
+
+	for (gsize i = 0; i < length; i++)
+		_append_code_point(output, bytes[i]);
+}
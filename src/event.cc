@@ -24,10 +24,35 @@
 
 #include "event.hh"
 
-Event::Event(const EventType type, const std::shared_ptr<const Glib::DateTime> timestamp, const User & subject, const User & object, const Glib::ustring & message) :
-	type(type),
+Event::Event() :
+	timestamp(0),
+	message(nullptr),
+	message_length(0),
+	subject(0),
+	object(0),
+	type(EventType::PARSE_IGNORE)
+{ }
+
+Event::Event(EventType type, gint64 timestamp, guint32 subject, guint32 object, const char * message, guint32 message_length) :
 	timestamp(timestamp),
+	message(message),
+	message_length(message_length),
 	subject(subject),
 	object(object),
-	message(message)
+	type(type)
 { }
+
+const User & Event::get_subject() const
+{
+	return User::get(this->subject);
+}
+
+const User & Event::get_object() const
+{
+	return User::get(this->object);
+}
+
+Glib::ustring Event::get_message() const
+{
+	return Glib::ustring(this->message, this->message + this->message_length);
+}
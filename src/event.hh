@@ -23,13 +23,12 @@
 #ifndef CHATSTATS_EVENT_HH
 #define CHATSTATS_EVENT_HH
 
-#include <memory>
-
-#include <glibmm/datetime.h>
+#include <glib.h>
+#include <glibmm/ustring.h>
 
 #include "user.hh"
 
-enum class EventType
+enum class EventType : guint8
 {
 	ACTION,
 	CTCP,
@@ -51,16 +50,19 @@ enum class EventType
 class Event
 {
 	public:
-		Event(const EventType type, std::shared_ptr<const Glib::DateTime> timestamp, const User & subject, const User & object, const Glib::ustring & message);
-
-		const EventType type;
-
-		const std::shared_ptr<const Glib::DateTime> timestamp;
+		Event();
+		Event(EventType type, gint64 timestamp, guint32 subject, guint32 object, const char * message, guint32 message_length);
 
-		const User subject;
-		const User object;
+		const User & get_subject() const;
+		const User & get_object() const;
+		Glib::ustring get_message() const;
 
-		const Glib::ustring message;
+		gint64 timestamp;
+		const char * message;
+		guint32 message_length;
+		guint32 subject;
+		guint32 object;
+		EventType type;
 };
 
 #endif // CHATSTATS_EVENT_HH
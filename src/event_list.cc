@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+
+#include "event_list.hh"
+
+EventList::EventList() :
+	_begin(0),
+	_end(0),
+	_ordered(true)
+{ }
+
+EventList::EventList(const std::shared_ptr<Arena> & arena) :
+	_arena(arena),
+	_begin(0),
+	_end(0),
+	_ordered(true)
+{ }
+
+EventList::EventList(const std::shared_ptr<Arena> & arena, const std::shared_ptr<Storage> & storage, size_t begin, size_t end, bool ordered) :
+	_arena(arena),
+	_storage(storage),
+	_begin(begin),
+	_end(end),
+	_ordered(ordered)
+{ }
+
+const Event * EventList::begin() const
+{
+	return this->_storage ? this->_storage->data() + this->_begin : nullptr;
+}
+
+const Event * EventList::end() const
+{
+	return this->_storage ? this->_storage->data() + this->_end : nullptr;
+}
+
+const Event & EventList::front() const
+{
+	return *this->begin();
+}
+
+const Event & EventList::back() const
+{
+	return *(this->end() - 1);
+}
+
+size_t EventList::size() const
+{
+	return this->_end - this->_begin;
+}
+
+bool EventList::empty() const
+{
+	return this->_begin == this->_end;
+}
+
+void EventList::push_back(const Event & event)
+{
+	if (!this->_storage)
+	{
+		this->_storage = this->_create_storage(nullptr, nullptr);
+	}
+	else if (this->_end != this->_storage->size() || this->_storage.use_count() > 1)
+	{
+		this->_storage = this->_create_storage(this->begin(), this->end());
+		this->_begin = 0;
+		this->_end = this->_storage->size();
+	}
+
+	if (!this->empty() && event.timestamp < this->back().timestamp)
+		this->_ordered = false;
+
+	this->_storage->push_back(event);
+	this->_end++;
+}
+
+void EventList::reserve(size_t count)
+{
+	const size_t size = this->size();
+
+	if (!this->_storage || this->_end != this->_storage->size() || this->_storage.use_count() > 1)
+	{
+		this->_storage = this->_create_storage(this->begin(), this->end());
+		this->_begin = 0;
+		this->_end = size;
+	}
+
+	this->_storage->reserve(count);
+}
+
+void EventList::compact(const std::shared_ptr<Arena> & arena)
+{
+	const size_t size = this->size();
+
+	this->_arena = arena;
+
+	if (this->_storage)
+	{
+		this->_storage = this->_create_storage(this->begin(), this->end());
+		this->_begin = 0;
+		this->_end = size;
+	}
+}
+
+const Event * EventList::find(gint64 timestamp) const
+{
+	if (this->_ordered)
+		return std::lower_bound(this->begin(), this->end(), timestamp, [](const Event & event, gint64 timestamp) { return event.timestamp < timestamp; });
+
+	return std::find_if(this->begin(), this->end(), [timestamp](const Event & event) { return event.timestamp >= timestamp; });
+}
+
+EventList EventList::split(const Event * position)
+{
+	const size_t index = this->_begin + (position - this->begin());
+
+	EventList tail(this->_arena, this->_storage, index, this->_end, this->_ordered);
+	this->_end = index;
+
+	return tail;
+}
+
+std::shared_ptr<EventList::Storage> EventList::_create_storage(const Event * begin, const Event * end) const
+{
+	return std::allocate_shared<Storage>(ArenaAllocator<Storage>(this->_arena.get()), begin, end, ArenaAllocator<Event>(this->_arena.get()));
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_EVENT_LIST_HH
+#define CHATSTATS_EVENT_LIST_HH
+
+#include <memory>
+#include <vector>
+
+#include "arena.hh"
+#include "event.hh"
+
+class EventList
+{
+	public:
+		EventList();
+		explicit EventList(const std::shared_ptr<Arena> & arena);
+
+		const Event * begin() const;
+		const Event * end() const;
+
+		const Event & front() const;
+		const Event & back() const;
+
+		size_t size() const;
+		bool empty() const;
+
+		void push_back(const Event & event);
+		void reserve(size_t count);
+		void compact(const std::shared_ptr<Arena> & arena);
+
+		const Event * find(gint64 timestamp) const;
+		EventList split(const Event * position);
+
+	private:
+		typedef std::vector<Event, ArenaAllocator<Event>> Storage;
+
+		EventList(const std::shared_ptr<Arena> & arena, const std::shared_ptr<Storage> & storage, size_t begin, size_t end, bool ordered);
+
+		std::shared_ptr<Storage> _create_storage(const Event * begin, const Event * end) const;
+
+		std::shared_ptr<Arena> _arena;
+		std::shared_ptr<Storage> _storage;
+
+		size_t _begin;
+		size_t _end;
+
+		bool _ordered;
+};
+
+#endif // CHATSTATS_EVENT_LIST_HH
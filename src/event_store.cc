@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+
+#include "event_store.hh"
+
+const size_t EventStore::BLOCK_SIZE = 4096;
+
+EventStore::EventStore() :
+	_id_count(0)
+{ }
+
+void EventStore::append(const Event & event, guint32 subject)
+{
+	const size_t row = this->_types.size();
+
+	if (this->_blocks.empty() || row - this->_blocks.back().start >= EventStore::BLOCK_SIZE || event.timestamp - this->_blocks.back().base_timestamp < G_MININT32 || event.timestamp - this->_blocks.back().base_timestamp > G_MAXINT32)
+		this->_blocks.push_back(Block{row, event.timestamp});
+
+	this->_timestamp_offsets.push_back(static_cast<gint32>(event.timestamp - this->_blocks.back().base_timestamp));
+	this->_types.push_back(event.type);
+	this->_subjects.push_back(subject);
+
+	this->_id_count = std::max(this->_id_count, subject + 1);
+}
+
+std::vector<Activity> EventStore::summarize(guint32 line_types) const
+{
+	std::vector<Activity> totals(this->_id_count, Activity{0, G_MAXINT64, G_MININT64});
+
+	for (size_t block = 0; block < this->_blocks.size(); block++)
+	{
+		const gint64 base_timestamp = this->_blocks[block].base_timestamp;
+		const size_t end = this->_get_block_end(block);
+
+		for (size_t row = this->_blocks[block].start; row < end; row++)
+		{
+			const gint64 timestamp = base_timestamp + this->_timestamp_offsets[row];
+			Activity & activity = totals[this->_subjects[row]];
+
+			activity.lines += (line_types >> static_cast<guint32>(this->_types[row])) & 1;
+			activity.first_seen = std::min(activity.first_seen, timestamp);
+			activity.last_seen = std::max(activity.last_seen, timestamp);
+		}
+	}
+
+	return totals;
+}
+
+size_t EventStore::_get_block_end(size_t block) const
+{
+	return block + 1 < this->_blocks.size() ? this->_blocks[block + 1].start : this->_types.size();
+}
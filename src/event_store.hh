@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHATSTATS_EVENT_STORE_HH
+#define CHATSTATS_EVENT_STORE_HH
+
+#include <vector>
+
+#include "event.hh"
+
+class Activity
+{
+	public:
+		gint64 lines;
+
+		gint64 first_seen;
+		gint64 last_seen;
+};
+
+class EventStore
+{
+	public:
+		const static size_t BLOCK_SIZE;
+
+		EventStore();
+
+		void append(const Event & event, guint32 subject);
+
+		std::vector<Activity> summarize(guint32 line_types) const;
+
+	private:
+		class Block
+		{
+			public:
+				size_t start;
+				gint64 base_timestamp;
+		};
+
+		size_t _get_block_end(size_t block) const;
+
+		std::vector<Block> _blocks;
+
+		std::vector<gint32> _timestamp_offsets;
+		std::vector<EventType> _types;
+		std::vector<guint32> _subjects;
+
+		guint32 _id_count;
+};
+
+#endif // CHATSTATS_EVENT_STORE_HH
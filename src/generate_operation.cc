@@ -20,36 +20,50 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 #include <giomm/datainputstream.h>
 #include <glibmm/miscutils.h>
-#include <glibmm/regex.h>
 
 #include "generate_operation.hh"
 #include "util.hh"
 #include "version.hh"
 
-GenerateOperation::GenerateOperation(const Glib::RefPtr<Gio::File> & input_directory, const std::shared_ptr<LogReader> & reader, const Glib::RefPtr<Gio::File> & output_directory, const Glib::RefPtr<Gio::File> & users_file, const bool debug, const bool separate_userhosts) :
+const size_t GenerateOperation::EVENT_INSERT_ROWS = 64;
+const size_t GenerateOperation::TRANSACTION_SIZE = 1000000;
+const int GenerateOperation::DATABASE_VERSION = 3;
+
+GenerateOperation::GenerateOperation(const Glib::RefPtr<Gio::File> & input_directory, const std::shared_ptr<LogReader> & reader, const Glib::RefPtr<Gio::File> & output_directory, const Glib::RefPtr<Gio::File> & users_file, const bool debug, const bool separate_userhosts, const std::string & database_filename) :
 	Operation(input_directory, reader),
 	_output_directory(output_directory),
 	_users_directory(Gio::File::create_for_path(Glib::build_filename(output_directory->get_path(), "users"))),
 	_users_file(users_file),
-	_database(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE),
+	_database(database_filename.empty() ? ":memory:" : database_filename.c_str(), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE),
+	_persistent(!database_filename.empty()),
+	_transaction_events(0),
+	_file_id(-1),
+	_file_target_recorded(false),
+	_users_file_checksum(users_file && users_file->query_exists() ? LogContents(users_file).get_checksum() : ""),
+	_users_file_changed(true),
 	_separate_userhosts(separate_userhosts),
 	_debug(debug)
 {
 	this->_initialize_database();
 	this->_users_directory->make_directory();
-	this->_load_users_file();
-	std::cout << "Processing files..." << std::endl;
 }
 
 void GenerateOperation::_cleanup()
 {
+	this->_finish_loading();
 	this->_initialize_database_indexes();
+	this->_load_target();
 	this->_apply_users_file();
+	this->_summarize_activity();
 	this->_create_undeclared_users();
 	this->_assign_aliases();
 
@@ -61,10 +75,132 @@ void GenerateOperation::_cleanup()
 		this->_print_debug_info();
 }
 
-void GenerateOperation::_handle_sessions(const std::vector<std::shared_ptr<Session>> &sessions)
+std::set<std::string> GenerateOperation::_get_input_filenames()
 {
+	std::set<std::string> filenames = Operation::_get_input_filenames();
+
+	this->_load_users_file();
+
 	SQLite::Transaction transaction(this->_database);
-	SQLite::Statement insert_event_query(this->_database, "INSERT INTO events (type, timestamp, subject_nickuserhost_id, object_nickuserhost_id, message) VALUES (:type, :timestamp, :subject_nickuserhost_id, :object_nickuserhost_id, :message)");
+	SQLite::Statement select_query(this->_database, "SELECT id, path, size, modification_time, checksum FROM files");
+	SQLite::Statement update_query(this->_database, "UPDATE files SET modification_time = ? WHERE id = ?");
+
+	std::vector<int> removed_file_ids;
+
+	while (select_query.executeStep())
+	{
+		const int file_id = select_query.getColumn(0).getInt();
+		const std::string path = select_query.getColumn(1).getText();
+
+		if (filenames.count(path) > 0)
+		{
+			auto file_info = Gio::File::create_for_path(path)->query_info("standard::size,time::modified");
+			const Glib::TimeVal modification_time = file_info->modification_time();
+			const sqlite3_int64 modification_microseconds = static_cast<sqlite3_int64>(modification_time.tv_sec) * 1000000 + modification_time.tv_usec;
+
+			if (file_info->get_size() == select_query.getColumn(2).getInt64())
+			{
+				if (modification_microseconds == select_query.getColumn(3).getInt64())
+				{
+					filenames.erase(path);
+					continue;
+				}
+
+				if (LogContents(Gio::File::create_for_path(path)).get_checksum() == select_query.getColumn(4).getText())
+				{
+					update_query.bind(1, modification_microseconds);
+					update_query.bind(2, file_id);
+					update_query.exec();
+					update_query.reset();
+
+					filenames.erase(path);
+					continue;
+				}
+			}
+		}
+
+		removed_file_ids.push_back(file_id);
+	}
+
+	if (!removed_file_ids.empty())
+	{
+		SQLite::Statement delete_activity_query(this->_database, "DELETE FROM activity WHERE file_id = ?");
+		SQLite::Statement delete_events_query(this->_database, "DELETE FROM events WHERE file_id = ?");
+		SQLite::Statement delete_file_query(this->_database, "DELETE FROM files WHERE id = ?");
+
+		for (const int file_id : removed_file_ids)
+		{
+			delete_activity_query.bind(1, file_id);
+			delete_activity_query.exec();
+			delete_activity_query.reset();
+
+			delete_events_query.bind(1, file_id);
+			delete_events_query.exec();
+			delete_events_query.reset();
+
+			delete_file_query.bind(1, file_id);
+			delete_file_query.exec();
+			delete_file_query.reset();
+		}
+
+		this->_database.exec(R"EOF(
+			DELETE FROM nickuserhosts
+				WHERE COALESCE(source_id, id) NOT IN (
+					SELECT COALESCE(source_id, id) FROM nickuserhosts
+						WHERE id IN (SELECT subject_nickuserhost_id FROM events WHERE subject_nickuserhost_id IS NOT NULL)
+						OR id IN (SELECT object_nickuserhost_id FROM events WHERE object_nickuserhost_id IS NOT NULL)
+				)
+		)EOF");
+	}
+
+	if (this->_persistent && this->_users_file_changed)
+	{
+		this->_apply_timed_nick_specifications();
+
+		SQLite::Statement checksum_query(this->_database, "INSERT OR REPLACE INTO settings (name, value) VALUES ('users_file_checksum', ?)");
+		checksum_query.bind(1, this->_users_file_checksum);
+		checksum_query.exec();
+	}
+
+	transaction.commit();
+
+	this->_load_nickuserhosts();
+
+	std::cout << Glib::ustring::compose("Processing %1 files...", filenames.size()) << std::endl;
+
+	return filenames;
+}
+
+void GenerateOperation::_begin_file(const std::string & filename, const LogContents & contents)
+{
+	this->_insert_activity();
+
+	if (this->_transaction && this->_transaction_events >= GenerateOperation::TRANSACTION_SIZE)
+	{
+		this->_transaction->commit();
+		this->_transaction.reset();
+		this->_transaction_events = 0;
+	}
+
+	if (!this->_transaction)
+		this->_transaction.reset(new SQLite::Transaction(this->_database));
+
+	SQLite::Statement insert_query(this->_database, "INSERT INTO files (path, size, modification_time, checksum, target) VALUES (?, ?, ?, ?, '')");
+
+	insert_query.bind(1, filename);
+	insert_query.bind(2, static_cast<sqlite3_int64>(contents.get_length()));
+	insert_query.bind(3, static_cast<sqlite3_int64>(contents.get_modification_time()));
+	insert_query.bind(4, this->_persistent ? contents.get_checksum() : "");
+	insert_query.exec();
+
+	this->_file_id = this->_database.getLastInsertRowid();
+	this->_file_target_recorded = false;
+}
+
+void GenerateOperation::_handle_sessions(const std::vector<std::shared_ptr<Session>> &sessions)
+{
+	if (!this->_transaction)
+		this->_transaction.reset(new SQLite::Transaction(this->_database));
 
 	for (auto & session: sessions)
 	{
@@ -73,59 +209,333 @@ void GenerateOperation::_handle_sessions(const std::vector<std::shared_ptr<Sessi
 
 		for (auto & event : session->events)
 		{
-			const int subject_nickuserhost_id = this->_get_nickuserhost_id(event->subject);
+			const User & subject = event.get_subject();
+			const User & object = event.get_object();
 
-			if (event->type == EventType::NICK_CHANGE)
-				this->_userhosts[event->object.nick] = this->_userhosts[event->subject.nick];
+			const int subject_nickuserhost_id = this->_get_nickuserhost_id(subject, event.timestamp);
 
-			const int object_nickuserhost_id = this->_get_nickuserhost_id(event->object);
+			if (event.type == EventType::NICK_CHANGE)
+				this->_userhosts[object.nick] = this->_userhosts[subject.nick];
 
-			insert_event_query.bind(":type", static_cast<int>(event->type));
-			insert_event_query.bind(":timestamp", event->timestamp->format("%Y-%m-%d %H:%M:%S"));
-			insert_event_query.bind(":message", event->message);
+			const int object_nickuserhost_id = this->_get_nickuserhost_id(object, event.timestamp);
 
-			if (subject_nickuserhost_id >= 0)
-				insert_event_query.bind(":subject_nickuserhost_id", subject_nickuserhost_id);
-			else
-				insert_event_query.bind(":subject_nickuserhost_id");
+			if (this->_persistent)
+			{
+				if (subject_nickuserhost_id >= 0)
+					this->_record_activity(subject_nickuserhost_id, event);
 
-			if (object_nickuserhost_id >= 0)
-				insert_event_query.bind(":object_nickuserhost_id", object_nickuserhost_id);
-			else
-				insert_event_query.bind(":object_nickuserhost_id");
+				this->_event_rows.push_back(EventRow{event, subject_nickuserhost_id, object_nickuserhost_id});
 
-			insert_event_query.exec();
-			insert_event_query.reset();
+				if (this->_event_rows.size() == GenerateOperation::EVENT_INSERT_ROWS)
+					this->_insert_event_rows();
+			}
+			else if (subject_nickuserhost_id >= 0)
+			{
+				this->_event_store.append(event, subject_nickuserhost_id);
+			}
 		}
 
-		if (this->_target.empty())
-			this->_target = session->target;
+		if (!this->_file_target_recorded && !session->target.empty())
+		{
+			SQLite::Statement update_query(this->_database, "UPDATE files SET target = ? WHERE id = ?");
+
+			update_query.bind(1, session->target);
+			update_query.bind(2, this->_file_id);
+			update_query.exec();
+
+			this->_file_target_recorded = true;
+		}
 
 		this->_last_session_stop = session->stop;
+		this->_transaction_events += session->events.size();
 	}
 
-	transaction.commit();
+	this->_insert_event_rows();
+}
+
+void GenerateOperation::_finish_loading()
+{
+	this->_insert_activity();
+
+	if (this->_transaction)
+	{
+		this->_transaction->commit();
+		this->_transaction.reset();
+	}
+
+	this->_event_insert_query.reset();
+	this->_event_rows_insert_query.reset();
+
+	if (!this->_persistent)
+		this->_database.exec("PRAGMA journal_mode = MEMORY");
+
+	this->_database.exec("PRAGMA synchronous = FULL");
+}
+
+void GenerateOperation::_load_target()
+{
+	SQLite::Statement query(this->_database, "SELECT target FROM files WHERE target != '' ORDER BY path LIMIT 1");
+
+	if (query.executeStep())
+		this->_target = query.getColumn(0).getText();
+}
+
+void GenerateOperation::_load_nickuserhosts()
+{
+	SQLite::Statement query(this->_database, "SELECT id, nickuserhost, source_id, user_id FROM nickuserhosts");
+
+	this->_stored_nickuserhost_ids.clear();
+	this->_copy_nickuserhost_ids.clear();
+
+	while (query.executeStep())
+	{
+		if (query.getColumn(2).isNull())
+			this->_stored_nickuserhost_ids[query.getColumn(1).getText()] = query.getColumn(0).getInt();
+		else
+			this->_copy_nickuserhost_ids[std::make_pair(query.getColumn(2).getInt(), query.getColumn(3).getInt())] = query.getColumn(0).getInt();
+	}
+}
+
+void GenerateOperation::_bind_event_row(SQLite::Statement & query, int column, const EventRow & row)
+{
+	const sqlite3_int64 timestamp = row.event.timestamp;
+	const int time_of_day = ((timestamp % 86400) + 86400) % 86400;
+
+	query.bind(column + 1, static_cast<int>(row.event.type));
+	query.bind(column + 2, timestamp);
+	query.bind(column + 3, time_of_day);
+
+	if (row.subject_nickuserhost_id >= 0)
+		query.bind(column + 4, row.subject_nickuserhost_id);
+	else
+		query.bind(column + 4);
+
+	if (row.object_nickuserhost_id >= 0)
+		query.bind(column + 5, row.object_nickuserhost_id);
+	else
+		query.bind(column + 5);
+
+	query.bindNoCopy(column + 6, row.event.message, row.event.message_length);
+	query.bind(column + 7, this->_file_id);
+}
+
+void GenerateOperation::_insert_event_rows()
+{
+	if (this->_event_rows.size() == GenerateOperation::EVENT_INSERT_ROWS)
+	{
+		for (size_t i = 0; i < this->_event_rows.size(); i++)
+			this->_bind_event_row(*this->_event_rows_insert_query, i * 7, this->_event_rows[i]);
+
+		this->_event_rows_insert_query->exec();
+		this->_event_rows_insert_query->reset();
+	}
+	else
+	{
+		for (const EventRow & row : this->_event_rows)
+		{
+			this->_bind_event_row(*this->_event_insert_query, 0, row);
+
+			this->_event_insert_query->exec();
+			this->_event_insert_query->reset();
+		}
+	}
+
+	this->_event_rows.clear();
+}
+
+void GenerateOperation::_record_activity(const int nickuserhost_id, const Event & event)
+{
+	const gint64 hour = (event.timestamp - (((event.timestamp % 3600) + 3600) % 3600)) / 3600;
+	auto iter = this->_activity.find(std::make_pair(nickuserhost_id, hour));
+
+	if (iter == this->_activity.end())
+		iter = this->_activity.insert(std::make_pair(std::make_pair(nickuserhost_id, hour), Activity{0, event.timestamp, event.timestamp})).first;
+
+	Activity & activity = iter->second;
+
+	if (event.type == EventType::ACTION || event.type == EventType::MESSAGE)
+		activity.lines++;
+
+	activity.first_seen = std::min(activity.first_seen, event.timestamp);
+	activity.last_seen = std::max(activity.last_seen, event.timestamp);
+}
+
+void GenerateOperation::_insert_activity()
+{
+	if (this->_activity.empty())
+		return;
+
+	SQLite::Statement query(this->_database, "INSERT INTO activity (file_id, nickuserhost_id, day, hour, lines, first_seen, last_seen) VALUES (?, ?, ?, ?, ?, ?, ?)");
+
+	for (auto & pair : this->_activity)
+	{
+		const gint64 hour = pair.first.second;
+		const gint64 hour_of_day = ((hour % 24) + 24) % 24;
+
+		query.bind(1, this->_file_id);
+		query.bind(2, pair.first.first);
+		query.bind(3, static_cast<sqlite3_int64>((hour - hour_of_day) / 24));
+		query.bind(4, static_cast<int>(hour_of_day));
+		query.bind(5, static_cast<sqlite3_int64>(pair.second.lines));
+		query.bind(6, static_cast<sqlite3_int64>(pair.second.first_seen));
+		query.bind(7, static_cast<sqlite3_int64>(pair.second.last_seen));
+		query.exec();
+		query.reset();
+	}
+
+	this->_activity.clear();
+}
+
+void GenerateOperation::_rebuild_activity(const std::set<int> & nickuserhost_ids)
+{
+	SQLite::Statement delete_query(this->_database, "DELETE FROM activity WHERE nickuserhost_id = :nickuserhost_id");
+	SQLite::Statement insert_query(this->_database, R"EOF(
+		INSERT INTO activity (file_id, nickuserhost_id, day, hour, lines, first_seen, last_seen)
+			SELECT file_id, subject_nickuserhost_id, (timestamp - time_of_day) / 86400 AS day, time_of_day / 3600 AS hour, SUM(type IN (:action_type, :message_type)), MIN(timestamp), MAX(timestamp)
+			FROM events
+			WHERE subject_nickuserhost_id = :nickuserhost_id
+			GROUP BY file_id, day, hour
+	)EOF");
+
+	insert_query.bind(":action_type", static_cast<int>(EventType::ACTION));
+	insert_query.bind(":message_type", static_cast<int>(EventType::MESSAGE));
+
+	for (const int nickuserhost_id : nickuserhost_ids)
+	{
+		delete_query.bind(":nickuserhost_id", nickuserhost_id);
+		delete_query.exec();
+		delete_query.reset();
+
+		insert_query.bind(":nickuserhost_id", nickuserhost_id);
+		insert_query.exec();
+		insert_query.reset();
+	}
+}
+
+void GenerateOperation::_summarize_activity()
+{
+	if (this->_persistent)
+	{
+		this->_database.exec(R"EOF(
+			CREATE TEMP TABLE totals AS
+				SELECT nickuserhost_id, SUM(lines) AS lines, MIN(first_seen) AS first_seen, MAX(last_seen) AS last_seen
+				FROM activity
+				GROUP BY nickuserhost_id
+		)EOF");
+	}
+	else
+	{
+		this->_database.exec("CREATE TEMP TABLE totals (nickuserhost_id INTEGER, lines INTEGER, first_seen INTEGER, last_seen INTEGER)");
+
+		SQLite::Transaction transaction(this->_database);
+		SQLite::Statement query(this->_database, "INSERT INTO totals (nickuserhost_id, lines, first_seen, last_seen) VALUES (?, ?, ?, ?)");
+
+		const std::vector<Activity> totals = this->_event_store.summarize((1 << static_cast<int>(EventType::ACTION)) | (1 << static_cast<int>(EventType::MESSAGE)));
+
+		for (size_t nickuserhost_id = 0; nickuserhost_id < totals.size(); nickuserhost_id++)
+		{
+			if (totals[nickuserhost_id].first_seen > totals[nickuserhost_id].last_seen)
+				continue;
+
+			query.bind(1, static_cast<int>(nickuserhost_id));
+			query.bind(2, static_cast<sqlite3_int64>(totals[nickuserhost_id].lines));
+			query.bind(3, static_cast<sqlite3_int64>(totals[nickuserhost_id].first_seen));
+			query.bind(4, static_cast<sqlite3_int64>(totals[nickuserhost_id].last_seen));
+			query.exec();
+			query.reset();
+		}
+
+		transaction.commit();
+	}
+
+	this->_database.exec("CREATE UNIQUE INDEX temp.totals_nickuserhost_id_index ON totals (nickuserhost_id ASC)");
 }
 
 void GenerateOperation::_initialize_database()
 {
 	this->_database.exec("PRAGMA case_sensitive_like = TRUE");
 	this->_database.exec("PRAGMA foreign_keys = TRUE");
+	this->_database.exec("PRAGMA synchronous = OFF");
+
+	if (!this->_persistent)
+		this->_database.exec("PRAGMA journal_mode = OFF");
+
+	const int version = this->_database.execAndGet("PRAGMA user_version").getInt();
+
+	if (version == 0)
+	{
+		this->_initialize_database_tables();
+		this->_database.exec(Glib::ustring::compose("PRAGMA user_version = %1", GenerateOperation::DATABASE_VERSION).c_str());
+	}
+	else if (version == GenerateOperation::DATABASE_VERSION)
+	{
+		this->_reset_database();
+	}
+	else
+	{
+		throw std::runtime_error(Glib::ustring::compose("Unsupported database version: %1", version));
+	}
 
-	this->_initialize_database_tables();
 	this->_initialize_database_queries();
 }
 
+void GenerateOperation::_reset_database()
+{
+	SQLite::Statement checksum_query(this->_database, "SELECT value FROM settings WHERE name = 'users_file_checksum'");
+
+	if (checksum_query.executeStep() && checksum_query.getColumn(0).getText() == this->_users_file_checksum)
+	{
+		this->_users_file_changed = false;
+
+		this->_database.exec(R"EOF(
+			UPDATE nickuserhosts SET user_id = NULL WHERE source_id IS NULL;
+			DELETE FROM users WHERE automatic = 1;
+		)EOF");
+
+		return;
+	}
+
+	SQLite::Transaction transaction(this->_database);
+	SQLite::Statement query(this->_database, "SELECT id, source_id FROM nickuserhosts WHERE source_id IS NOT NULL");
+
+	std::set<int> nickuserhost_ids;
+
+	while (query.executeStep())
+	{
+		nickuserhost_ids.insert(query.getColumn(0).getInt());
+		nickuserhost_ids.insert(query.getColumn(1).getInt());
+	}
+
+	this->_database.exec(R"EOF(
+		UPDATE events SET subject_nickuserhost_id = (SELECT source_id FROM nickuserhosts WHERE id = events.subject_nickuserhost_id)
+			WHERE subject_nickuserhost_id IN (SELECT id FROM nickuserhosts WHERE source_id IS NOT NULL);
+		UPDATE events SET object_nickuserhost_id = (SELECT source_id FROM nickuserhosts WHERE id = events.object_nickuserhost_id)
+			WHERE object_nickuserhost_id IN (SELECT id FROM nickuserhosts WHERE source_id IS NOT NULL);
+	)EOF");
+
+	this->_rebuild_activity(nickuserhost_ids);
+
+	this->_database.exec(R"EOF(
+		DELETE FROM nickuserhosts WHERE source_id IS NOT NULL;
+		UPDATE nickuserhosts SET user_id = NULL;
+		DELETE FROM users;
+	)EOF");
+
+	transaction.commit();
+}
+
 void GenerateOperation::_initialize_database_tables()
 {
 	this->_database.exec(R"EOF(
 		CREATE TABLE events (
 			id INTEGER PRIMARY KEY,
 			type INTEGER NOT NULL,
-			timestamp TEXT NOT NULL,
+			timestamp INTEGER NOT NULL,
+			time_of_day INTEGER NOT NULL,
 			subject_nickuserhost_id INTEGER REFERENCES nickuserhosts(id),
 			object_nickuserhost_id INTEGER REFERENCES nickuserhosts(id),
-			message TEXT
+			message TEXT,
+			file_id INTEGER REFERENCES files(id)
 		);
 	)EOF");
 
@@ -133,6 +543,7 @@ void GenerateOperation::_initialize_database_tables()
 		CREATE TABLE nickuserhosts (
 			id INTEGER PRIMARY KEY,
 			user_id INTEGER REFERENCES users(id),
+			source_id INTEGER REFERENCES nickuserhosts(id),
 			nickuserhost TEXT NOT NULL
 		);
 	)EOF");
@@ -145,6 +556,36 @@ void GenerateOperation::_initialize_database_tables()
 		)
 	)EOF");
 
+	this->_database.exec(R"EOF(
+		CREATE TABLE activity (
+			file_id INTEGER REFERENCES files(id),
+			nickuserhost_id INTEGER NOT NULL REFERENCES nickuserhosts(id),
+			day INTEGER NOT NULL,
+			hour INTEGER NOT NULL,
+			lines INTEGER NOT NULL,
+			first_seen INTEGER NOT NULL,
+			last_seen INTEGER NOT NULL
+		)
+	)EOF");
+
+	this->_database.exec(R"EOF(
+		CREATE TABLE files (
+			id INTEGER PRIMARY KEY,
+			path TEXT UNIQUE NOT NULL,
+			size INTEGER NOT NULL,
+			modification_time INTEGER NOT NULL,
+			checksum TEXT NOT NULL,
+			target TEXT NOT NULL
+		)
+	)EOF");
+
+	this->_database.exec(R"EOF(
+		CREATE TABLE settings (
+			name TEXT PRIMARY KEY,
+			value TEXT NOT NULL
+		)
+	)EOF");
+
 	this->_database.exec(R"EOF(
 		CREATE VIEW nicks AS
 			SELECT DISTINCT u.id AS id, SUBSTR(n.nickuserhost, 0, INSTR(n.nickuserhost, '!')) AS nick
@@ -158,28 +599,38 @@ void GenerateOperation::_initialize_database_indexes()
 	std::cout << "Creating indexes..." << std::endl;
 
 	this->_database.exec(R"EOF(
-		CREATE INDEX subject_nickuserhost_id_index ON events (subject_nickuserhost_id ASC);
-		CREATE INDEX object_nickuserhost_id_index ON events (object_nickuserhost_id ASC);
-		CREATE INDEX timestamp_index ON events (timestamp ASC);
+		CREATE INDEX IF NOT EXISTS subject_nickuserhost_id_index ON events (subject_nickuserhost_id ASC, timestamp ASC);
+		CREATE INDEX IF NOT EXISTS object_nickuserhost_id_index ON events (object_nickuserhost_id ASC, timestamp ASC);
+		CREATE INDEX IF NOT EXISTS timestamp_index ON events (timestamp ASC);
+		CREATE INDEX IF NOT EXISTS file_id_index ON events (file_id ASC);
 
-		CREATE INDEX user_id_index ON nickuserhosts (user_id ASC);
+		CREATE INDEX IF NOT EXISTS user_id_index ON nickuserhosts (user_id ASC);
+		CREATE INDEX IF NOT EXISTS source_id_index ON nickuserhosts (source_id ASC);
+
+		CREATE INDEX IF NOT EXISTS activity_nickuserhost_id_index ON activity (nickuserhost_id ASC);
+		CREATE INDEX IF NOT EXISTS activity_file_id_index ON activity (file_id ASC);
 	)EOF");
 }
 
 void GenerateOperation::_initialize_database_queries()
 {
-	this->_nickuserhost_insert_query = std::make_shared<SQLite::Statement>(this->_database, "INSERT INTO nickuserhosts (user_id, nickuserhost) VALUES (:user_id, :nickuserhost)");
-}
+	this->_nickuserhost_insert_query = std::make_shared<SQLite::Statement>(this->_database, "INSERT INTO nickuserhosts (nickuserhost) VALUES (?)");
+	this->_nickuserhost_copy_insert_query = std::make_shared<SQLite::Statement>(this->_database, "INSERT INTO nickuserhosts (user_id, source_id, nickuserhost) VALUES (?, ?, ?)");
 
-void GenerateOperation::_insert_nick_specification(std::list<std::pair<std::shared_ptr<const NickSpecification>, int>> & nick_specifications, const std::shared_ptr<const NickSpecification> & nick_specification, const int user_id)
-{
-	auto iter = nick_specifications.begin();
+	const std::string insert_event_query = "INSERT INTO events (type, timestamp, time_of_day, subject_nickuserhost_id, object_nickuserhost_id, message, file_id) VALUES (?, ?, ?, ?, ?, ?, ?)";
+	std::string insert_event_rows_query = insert_event_query;
 
-	for (; iter != nick_specifications.end(); iter++)
-		if (iter->first->regex->match(nick_specification->nickuserhost_specification))
-			break;
+	for (size_t i = 1; i < GenerateOperation::EVENT_INSERT_ROWS; i++)
+		insert_event_rows_query += ", (?, ?, ?, ?, ?, ?, ?)";
 
-	nick_specifications.insert(iter, std::make_pair(nick_specification, user_id));
+	this->_event_insert_query = std::make_shared<SQLite::Statement>(this->_database, insert_event_query.c_str());
+	this->_event_rows_insert_query = std::make_shared<SQLite::Statement>(this->_database, insert_event_rows_query.c_str());
+}
+
+void GenerateOperation::_sort_nick_specifications(std::vector<std::pair<std::shared_ptr<const NickSpecification>, int>> & nick_specifications)
+{
+	std::reverse(nick_specifications.begin(), nick_specifications.end());
+	std::stable_sort(nick_specifications.begin(), nick_specifications.end(), [](const std::pair<std::shared_ptr<const NickSpecification>, int> & a, const std::pair<std::shared_ptr<const NickSpecification>, int> & b) { return a.first->specificity < b.first->specificity; });
 }
 
 void GenerateOperation::_load_users_file()
@@ -188,27 +639,61 @@ void GenerateOperation::_load_users_file()
 
 	SQLite::Transaction transaction(this->_database);
 	SQLite::Statement query(this->_database, "INSERT INTO users (alias, automatic) VALUES (:alias, 0)");
+	SQLite::Statement select_query(this->_database, "SELECT id FROM users WHERE automatic = 0 ORDER BY id");
+	SQLite::Statement update_query(this->_database, "UPDATE users SET alias = :alias WHERE id = :user_id");
+
+	std::vector<std::shared_ptr<UserSpecification>> users;
+
+	if (!this->_parse_cache || this->_users_file_checksum.empty() || !this->_parse_cache->load_users_file(this->_users_file_checksum, users))
+	{
+		users = this->_parse_users_file();
+
+		if (this->_parse_cache && !this->_users_file_checksum.empty())
+			this->_parse_cache->store_users_file(this->_users_file_checksum, users);
+	}
 
 	int current_user_id = -1;
 
-	for (auto & user : this->_parse_users_file())
+	for (auto & user : users)
 	{
-		query.bind(":alias", user->alias);
-		query.exec();
-		query.reset();
+		if (this->_users_file_changed)
+		{
+			query.bind(":alias", user->alias);
+			query.exec();
+			query.reset();
 
-		current_user_id = this->_database.getLastInsertRowid();
+			current_user_id = this->_database.getLastInsertRowid();
+		}
+		else
+		{
+			select_query.executeStep();
+			current_user_id = select_query.getColumn(0).getInt();
+
+			update_query.bind(":alias", user->alias);
+			update_query.bind(":user_id", current_user_id);
+			update_query.exec();
+			update_query.reset();
+		}
 
 		for (auto & nick_specification : user->nick_specifications)
 		{
 			if (nick_specification->time_range)
-				this->_insert_nick_specification(this->_timed_nick_specifications, nick_specification, current_user_id);
+				this->_timed_nick_specifications.push_back(std::make_pair(nick_specification, current_user_id));
 			else
-				this->_insert_nick_specification(this->_untimed_nick_specifications, nick_specification, current_user_id);
+				this->_untimed_nick_specifications.push_back(std::make_pair(nick_specification, current_user_id));
 		}
 	}
 
 	transaction.commit();
+
+	GenerateOperation::_sort_nick_specifications(this->_timed_nick_specifications);
+	GenerateOperation::_sort_nick_specifications(this->_untimed_nick_specifications);
+
+	for (auto & spec_pair : this->_timed_nick_specifications)
+		this->_timed_nick_matcher.add(spec_pair.first->nickuserhost_specification);
+
+	for (auto & spec_pair : this->_untimed_nick_specifications)
+		this->_untimed_nick_matcher.add(spec_pair.first->nickuserhost_specification);
 }
 
 void GenerateOperation::_apply_users_file()
@@ -216,54 +701,78 @@ void GenerateOperation::_apply_users_file()
 	std::cout << "Applying users file..." << std::endl;
 
 	SQLite::Transaction transaction(this->_database);
-	auto query = std::make_shared<SQLite::Statement>(this->_database, "SELECT id, nickuserhost FROM nickuserhosts");
+	auto query = std::make_shared<SQLite::Statement>(this->_database, "SELECT id, nickuserhost FROM nickuserhosts WHERE source_id IS NULL");
 
 	std::vector<std::pair<int, std::string>> nickuserhosts;
 
 	while (query->executeStep())
 		nickuserhosts.push_back(std::make_pair(query->getColumn(0).getInt(), query->getColumn(1).getText()));
 
-	SQLite::Statement insert_nickuserhost_query(this->_database, "INSERT INTO nickuserhosts (user_id, nickuserhost) VALUES (:user_id, :nickuserhost)");
 	SQLite::Statement update_nickuserhost_query(this->_database, "UPDATE nickuserhosts SET user_id = :user_id WHERE id = :nickuserhost_id");
+
+	for (auto & pair : nickuserhosts)
+	{
+		const int index = this->_untimed_nick_matcher.match(pair.second);
+
+		if (index >= 0)
+		{
+			update_nickuserhost_query.bind(":user_id", this->_untimed_nick_specifications[index].second);
+			update_nickuserhost_query.bind(":nickuserhost_id", pair.first);
+			update_nickuserhost_query.exec();
+			update_nickuserhost_query.reset();
+		}
+	}
+
+	transaction.commit();
+}
+
+void GenerateOperation::_apply_timed_nick_specifications()
+{
+	SQLite::Statement query(this->_database, "SELECT id, nickuserhost FROM nickuserhosts WHERE source_id IS NULL");
+
+	std::vector<std::pair<int, std::string>> nickuserhosts;
+
+	while (query.executeStep())
+		nickuserhosts.push_back(std::make_pair(query.getColumn(0).getInt(), query.getColumn(1).getText()));
+
+	std::set<int> remapped_nickuserhost_ids;
+
 	Glib::ustring update_events_query_template("UPDATE events SET %1_nickuserhost_id = :new_nickuserhost_id WHERE %1_nickuserhost_id = :nickuserhost_id AND %2");
 
+	std::vector<std::vector<std::shared_ptr<SQLite::Statement>>> update_events_queries;
+
 	for (auto & spec_pair : this->_timed_nick_specifications)
 	{
-		const auto & nick_specification = spec_pair.first;
-		const int user_id = spec_pair.second;
+		Glib::ustring time_range_expression = spec_pair.first->time_range->get_sql_expression();
 
-		Glib::ustring time_range_expression = nick_specification->time_range->get_sql_expression();
+		update_events_queries.push_back(std::vector<std::shared_ptr<SQLite::Statement>>());
+		update_events_queries.back().push_back(std::make_shared<SQLite::Statement>(this->_database, Glib::ustring::compose(update_events_query_template, "subject", time_range_expression).data()));
+		update_events_queries.back().push_back(std::make_shared<SQLite::Statement>(this->_database, Glib::ustring::compose(update_events_query_template, "object", time_range_expression).data()));
+	}
 
-		std::vector<std::shared_ptr<SQLite::Statement>> update_events_queries;
-		update_events_queries.push_back(std::make_shared<SQLite::Statement>(this->_database, Glib::ustring::compose(update_events_query_template, "subject", time_range_expression).data()));
-		update_events_queries.push_back(std::make_shared<SQLite::Statement>(this->_database, Glib::ustring::compose(update_events_query_template, "object", time_range_expression).data()));
+	for (auto & pair : nickuserhosts)
+	{
+		const int nickuserhost_id = pair.first;
+		const std::string & nickuserhost = pair.second;
 
-		for (auto & pair : nickuserhosts)
+		for (const size_t index : this->_timed_nick_matcher.match_all(nickuserhost))
 		{
-			const int nickuserhost_id = pair.first;
-			const Glib::ustring & nickuserhost = pair.second;
+			const int new_nickuserhost_id = this->_get_copy_nickuserhost_id(nickuserhost_id, this->_timed_nick_specifications[index].second, nickuserhost);
 
-			if (nick_specification->regex->match(nickuserhost))
+			for (auto & query : update_events_queries[index])
 			{
-				insert_nickuserhost_query.bind(":user_id", user_id);
-				insert_nickuserhost_query.bind(":nickuserhost", nickuserhost);
-				insert_nickuserhost_query.exec();
-				insert_nickuserhost_query.reset();
-
-				const int new_nickuserhost_id = this->_database.getLastInsertRowid();
-
-				for (auto & query : update_events_queries)
-				{
-					query->bind(":new_nickuserhost_id", new_nickuserhost_id);
-					query->bind(":nickuserhost_id", nickuserhost_id);
-					query->exec();
-					query->reset();
-				}
+				query->bind(":new_nickuserhost_id", new_nickuserhost_id);
+				query->bind(":nickuserhost_id", nickuserhost_id);
+				query->exec();
+				query->reset();
 			}
+
+			remapped_nickuserhost_ids.insert(nickuserhost_id);
+			remapped_nickuserhost_ids.insert(new_nickuserhost_id);
 		}
 	}
 
-	transaction.commit();
+	this->_rebuild_activity(remapped_nickuserhost_ids);
 }
 
 std::vector<std::shared_ptr<UserSpecification>> GenerateOperation::_parse_users_file() const
@@ -283,7 +792,7 @@ std::vector<std::shared_ptr<UserSpecification>> GenerateOperation::_parse_users_
 		if (line.empty())
 			continue;
 
-		std::vector<Glib::ustring> tokens = Glib::Regex::create("[\t ]+")->split(line);
+		const std::vector<std::string> tokens = split_whitespace(line);
 
 		if (tokens[0] == "USER" || (tokens[0] == "NICK" && !user))
 		{
@@ -330,13 +839,10 @@ void GenerateOperation::_assign_aliases()
 	std::cout << "Assigning aliases" << std::endl;
 
 	SQLite::Transaction transaction(this->_database);
-	SQLite::Statement select_query(this->_database, "SELECT u.id, SUBSTR(n.nickuserhost, 0, INSTR(n.nickuserhost, '!')) AS nick, COUNT(*) FROM nickuserhosts n, users u LEFT OUTER JOIN events e ON e.subject_nickuserhost_id = n.id AND (e.type == :action_type OR e.type == :message_type) WHERE n.user_id = u.id AND u.alias = '' GROUP BY u.id, nick;");
+	SQLite::Statement select_query(this->_database, "SELECT u.id, SUBSTR(n.nickuserhost, 0, INSTR(n.nickuserhost, '!')) AS nick, SUM(MAX(COALESCE(t.lines, 0), 1)) FROM nickuserhosts n, users u LEFT OUTER JOIN totals t ON t.nickuserhost_id = n.id WHERE n.user_id = u.id AND u.alias = '' GROUP BY u.id, nick;");
 
 	std::unordered_map<int, std::pair<std::string, int>> aliases;
 
-	select_query.bind(":action_type", static_cast<int>(EventType::ACTION));
-	select_query.bind(":message_type", static_cast<int>(EventType::MESSAGE));
-
 	while (select_query.executeStep())
 	{
 		const int user_id = select_query.getColumn(0).getInt();
@@ -484,30 +990,19 @@ void GenerateOperation::_output_html_footer(const Glib::RefPtr<Gio::DataOutputSt
 	output_stream->put_string("</html>\n");
 }
 
-void GenerateOperation::_output_html_user_index(const Glib::RefPtr<Gio::File> & user_file, const int user_id)
+void GenerateOperation::_output_html_user_index(const UserPage & page) const
 {
-	auto query = std::make_shared<SQLite::Statement>(this->_database, ("SELECT alias FROM users WHERE id = :user_id"));
-	query->bind(":user_id", user_id);
-	query->executeStep();
+	const Glib::RefPtr<Gio::DataOutputStream> output_stream = Gio::DataOutputStream::create(page.file->create_file());
 
-	Glib::ustring alias = query->getColumn(0).getText();
-
-	const Glib::RefPtr<Gio::DataOutputStream> output_stream = Gio::DataOutputStream::create(user_file->create_file());
-
-	this->_output_html_header(output_stream, Glib::ustring::compose("Users &raquo; %1", encode_html_characters(alias)), "../../");
+	this->_output_html_header(output_stream, Glib::ustring::compose("Users &raquo; %1", encode_html_characters(page.alias)), "../../");
 
 	output_stream->put_string("\t\t\t<table>\n");
 	output_stream->put_string("\t\t\t\t<thead>\n");
 	output_stream->put_string("\t\t\t\t\t<tr><th>Nickname</th><th>Lines</th></tr>\n");
 	output_stream->put_string("\t\t\t\t<tbody>\n");
 
-	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT SUBSTR(n.nickuserhost, 0, INSTR(n.nickuserhost, '!')) AS nick, COUNT(e.id) AS lines FROM nickuserhosts n LEFT OUTER JOIN events e ON n.id = e.subject_nickuserhost_id AND (e.type == :action_type OR e.type == :message_type) WHERE n.user_id = :user_id GROUP BY nick ORDER BY lines DESC");
-	query->bind(":user_id", user_id);
-	query->bind(":action_type", static_cast<int>(EventType::ACTION));
-	query->bind(":message_type", static_cast<int>(EventType::MESSAGE));
-
-	while (query->executeStep())
-		output_stream->put_string(Glib::ustring::compose("\t\t\t\t\t<tr><td>%1</td><td>%2</td></tr>\n", query->getColumn(0).getText(), query->getColumn(1).getInt()));
+	for (auto & pair : page.nicks)
+		output_stream->put_string(Glib::ustring::compose("\t\t\t\t\t<tr><td>%1</td><td>%2</td></tr>\n", pair.first, pair.second));
 
 	output_stream->put_string("\t\t\t\t</tbody>\n");
 	output_stream->put_string("\t\t\t</table>\n");
@@ -515,6 +1010,55 @@ void GenerateOperation::_output_html_user_index(const Glib::RefPtr<Gio::File> &
 	this->_output_html_footer(output_stream);
 }
 
+void GenerateOperation::_output_html_user_indexes(const std::vector<UserPage> & pages) const
+{
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+
+	size_t next = 0;
+	std::exception_ptr error;
+
+	auto worker = [&]()
+	{
+		while (true)
+		{
+			size_t index;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (error || next >= pages.size())
+					return;
+
+				index = next++;
+			}
+
+			try
+			{
+				this->_output_html_user_index(pages[index]);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+	};
+
+	for (size_t i = 1; i < this->_jobs && i < pages.size(); i++)
+		workers.push_back(std::thread(worker));
+
+	worker();
+
+	for (auto & thread : workers)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
 void GenerateOperation::_output_html_section_overall_ranking(const Glib::RefPtr<Gio::DataOutputStream> & output_stream)
 {
 	output_stream->put_string("\t\t\t<table>\n");
@@ -532,14 +1076,14 @@ void GenerateOperation::_output_html_section_overall_ranking(const Glib::RefPtr<
 	while (query->executeStep())
 		nick_counts[query->getColumn(0).getInt()] = query->getColumn(1).getInt();
 
+	std::vector<UserPage> pages;
+	std::unordered_map<int, size_t> page_indexes;
+
 	unsigned int index = 0;
 	unsigned int current_rank = 0;
 	unsigned int last_score = 0;
 
-	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.id, u.alias, COUNT(e.id) AS count FROM users u, nickuserhosts n LEFT OUTER JOIN events e ON n.id = e.subject_nickuserhost_id AND (e.type = :action_type OR e.type = :message_type) WHERE u.id = n.user_id GROUP BY u.id ORDER BY count DESC");
-
-	query->bind(":action_type", static_cast<int>(EventType::ACTION));
-	query->bind(":message_type", static_cast<int>(EventType::MESSAGE));
+	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.id, u.alias, COALESCE(SUM(t.lines), 0) AS count FROM users u, nickuserhosts n LEFT OUTER JOIN totals t ON n.id = t.nickuserhost_id WHERE u.id = n.user_id GROUP BY u.id ORDER BY count DESC");
 
 	while (query->executeStep())
 	{
@@ -554,7 +1098,9 @@ void GenerateOperation::_output_html_section_overall_ranking(const Glib::RefPtr<
 			break;
 
 		const Glib::RefPtr<Gio::File> user_directory = this->_get_user_directory(alias);
-		this->_output_html_user_index(Gio::File::create_for_path(Glib::build_filename(user_directory->get_path(), "index.html")), user_id);
+
+		page_indexes[user_id] = pages.size();
+		pages.push_back(UserPage{Gio::File::create_for_path(Glib::build_filename(user_directory->get_path(), "index.html")), alias, std::vector<std::pair<std::string, int>>()});
 
 		output_stream->put_string(Glib::ustring::compose("\t\t\t\t\t<tr><td>%1</td><td><a href=\"%2\">%3</a></td><td>%4</td><td>%5</td></tr>\n", current_rank, Glib::ustring::compose("users/%1/", user_directory->get_basename()), encode_html_characters(alias), score, nick_counts[user_id]));
 
@@ -567,45 +1113,84 @@ void GenerateOperation::_output_html_section_overall_ranking(const Glib::RefPtr<
 
 	if (index < nick_counts.size())
 		output_stream->put_string(Glib::ustring::compose("\t\t\t<p>Plus %1 others who obviously weren't important enough for the table</p>\n", nick_counts.size() - index));
+
+	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT n.user_id, SUBSTR(n.nickuserhost, 0, INSTR(n.nickuserhost, '!')) AS nick, COALESCE(SUM(t.lines), 0) AS lines FROM nickuserhosts n LEFT OUTER JOIN totals t ON n.id = t.nickuserhost_id WHERE n.user_id IS NOT NULL GROUP BY n.user_id, nick ORDER BY n.user_id, lines DESC, nick");
+
+	while (query->executeStep())
+	{
+		auto iter = page_indexes.find(query->getColumn(0).getInt());
+
+		if (iter != page_indexes.end())
+			pages[iter->second].nicks.push_back(std::make_pair(query->getColumn(1).getText(), query->getColumn(2).getInt()));
+	}
+
+	this->_output_html_user_indexes(pages);
 }
 
-int GenerateOperation::_get_nickuserhost_id(const User & user)
+int GenerateOperation::_get_nickuserhost_id(const User & user, gint64 timestamp)
 {
-	if (user.nick.empty())
+	if (user.nick == StringPool::EMPTY)
 		return -1;
 
-	if (!user.user.empty() && !user.host.empty())
-		this->_userhosts[user.nick] = Glib::ustring::compose("%1@%2", user.user, user.host);
-
-	if (this->_userhosts.count(user.nick) == 0)
-		this->_userhosts[user.nick] = "@";
+	if (user.user != StringPool::EMPTY && user.host != StringPool::EMPTY)
+		this->_userhosts[user.nick] = std::make_pair(user.user, user.host);
 
-	std::string nickuserhost(user.nick + '!' + this->_userhosts[user.nick]);
+	const auto & userhost = this->_userhosts[user.nick];
+	const guint32 nickuserhost_id = User::intern(this->_user_cache, User(user.nick, userhost.first, userhost.second));
 
-	if (this->_nickuserhost_ids.count(nickuserhost) == 0)
+	if (this->_nickuserhost_ids.count(nickuserhost_id) == 0)
 	{
-		this->_nickuserhost_insert_query->bind(":user_id");
+		std::string nickuserhost(user.get_nick() + '!' + StringPool::get(userhost.first) + '@' + StringPool::get(userhost.second));
+		auto iter = this->_stored_nickuserhost_ids.find(nickuserhost);
 
-		for (auto & pair : this->_untimed_nick_specifications)
+		if (iter != this->_stored_nickuserhost_ids.end())
 		{
-			const auto & nick_specification = pair.first;
-			const int user_id = pair.second;
+			this->_nickuserhost_ids[nickuserhost_id] = iter->second;
+		}
+		else
+		{
+			this->_nickuserhost_insert_query->bind(1, nickuserhost);
+			this->_nickuserhost_insert_query->exec();
+			this->_nickuserhost_insert_query->reset();
 
-			if (nick_specification->regex->match(nickuserhost))
-			{
-				this->_nickuserhost_insert_query->bind(":user_id", user_id);
-				break;
-			}
+			this->_nickuserhost_ids[nickuserhost_id] = this->_database.getLastInsertRowid();
 		}
 
-		this->_nickuserhost_insert_query->bind(":nickuserhost", nickuserhost);
-		this->_nickuserhost_insert_query->exec();
-		this->_nickuserhost_insert_query->reset();
+		const int source_id = this->_nickuserhost_ids[nickuserhost_id];
 
-		this->_nickuserhost_ids[nickuserhost] = this->_database.getLastInsertRowid();
+		for (const size_t index : this->_timed_nick_matcher.match_all(nickuserhost))
+		{
+			const auto & spec_pair = this->_timed_nick_specifications[index];
+			this->_timed_nickuserhost_ids[source_id].push_back(std::make_pair(spec_pair.first->time_range, this->_get_copy_nickuserhost_id(source_id, spec_pair.second, nickuserhost)));
+		}
 	}
 
-	return this->_nickuserhost_ids[nickuserhost];
+	const int source_id = this->_nickuserhost_ids[nickuserhost_id];
+	auto iter = this->_timed_nickuserhost_ids.find(source_id);
+
+	if (iter != this->_timed_nickuserhost_ids.end())
+		for (auto & pair : iter->second)
+			if (pair.first->contains(timestamp))
+				return pair.second;
+
+	return source_id;
+}
+
+int GenerateOperation::_get_copy_nickuserhost_id(const int source_id, const int user_id, const std::string & nickuserhost)
+{
+	const auto key = std::make_pair(source_id, user_id);
+	auto iter = this->_copy_nickuserhost_ids.find(key);
+
+	if (iter != this->_copy_nickuserhost_ids.end())
+		return iter->second;
+
+	this->_nickuserhost_copy_insert_query->bind(1, user_id);
+	this->_nickuserhost_copy_insert_query->bind(2, source_id);
+	this->_nickuserhost_copy_insert_query->bind(3, nickuserhost);
+	this->_nickuserhost_copy_insert_query->exec();
+	this->_nickuserhost_copy_insert_query->reset();
+
+	return this->_copy_nickuserhost_ids[key] = this->_database.getLastInsertRowid();
 }
 
 void GenerateOperation::_print_debug_info()
@@ -616,9 +1201,7 @@ void GenerateOperation::_print_debug_info()
 	std::cout << "Declared Users" << std::endl;
 	std::cout << "--------------------------------------------------------------------------------" << std::endl;
 
-	auto query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.alias, COUNT(e.id) AS lines FROM users u, nickuserhosts n LEFT OUTER JOIN events e on e.subject_nickuserhost_id = n.id AND e.type IN (:action_type, :message_type) WHERE u.id = n.user_id AND u.automatic = 0 GROUP BY u.id ORDER BY lines DESC");
-	query->bind(":action_type", static_cast<int>(EventType::ACTION));
-	query->bind(":message_type", static_cast<int>(EventType::MESSAGE));
+	auto query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.alias, COALESCE(SUM(t.lines), 0) AS lines FROM users u, nickuserhosts n LEFT OUTER JOIN totals t ON t.nickuserhost_id = n.id WHERE u.id = n.user_id AND u.automatic = 0 GROUP BY u.id ORDER BY lines DESC");
 
 	while (query->executeStep())
 	{
@@ -631,9 +1214,7 @@ void GenerateOperation::_print_debug_info()
 	std::cout << "Automatic Users" << std::endl;
 	std::cout << "--------------------------------------------------------------------------------" << std::endl;
 
-	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.alias, COUNT(e.id) AS lines FROM users u, nickuserhosts n LEFT OUTER JOIN events e on e.subject_nickuserhost_id = n.id AND e.type IN (:action_type, :message_type) WHERE u.id = n.user_id AND u.automatic = 1 GROUP BY u.id ORDER BY lines DESC");
-	query->bind(":action_type", static_cast<int>(EventType::ACTION));
-	query->bind(":message_type", static_cast<int>(EventType::MESSAGE));
+	query = std::make_shared<SQLite::Statement>(this->_database, "SELECT u.alias, COALESCE(SUM(t.lines), 0) AS lines FROM users u, nickuserhosts n LEFT OUTER JOIN totals t ON t.nickuserhost_id = n.id WHERE u.id = n.user_id AND u.automatic = 1 GROUP BY u.id ORDER BY lines DESC");
 
 	while (query->executeStep())
 	{
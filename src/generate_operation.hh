@@ -23,19 +23,47 @@
 #ifndef CHATSTATS_GENERATE_OPERATION_HH
 #define CHATSTATS_GENERATE_OPERATION_HH
 
+#include <map>
+
 #include <giomm/dataoutputstream.h>
 
 #include "SQLiteC++.h"
 
+#include "event_store.hh"
+#include "nick_matcher.hh"
 #include "operation.hh"
 #include "user_specification.hh"
 
+class EventRow
+{
+	public:
+		Event event;
+
+		int subject_nickuserhost_id;
+		int object_nickuserhost_id;
+};
+
+class UserPage
+{
+	public:
+		Glib::RefPtr<Gio::File> file;
+		Glib::ustring alias;
+
+		std::vector<std::pair<std::string, int>> nicks;
+};
+
 class GenerateOperation : public Operation
 {
 	public:
-		GenerateOperation(const Glib::RefPtr<Gio::File> & input_directory, const std::shared_ptr<LogReader> & reader, const Glib::RefPtr<Gio::File> & output_directory, const Glib::RefPtr<Gio::File> & users_file, const bool debug, const bool separate_userhosts);
+		const static size_t EVENT_INSERT_ROWS;
+		const static size_t TRANSACTION_SIZE;
+		const static int DATABASE_VERSION;
+
+		GenerateOperation(const Glib::RefPtr<Gio::File> & input_directory, const std::shared_ptr<LogReader> & reader, const Glib::RefPtr<Gio::File> & output_directory, const Glib::RefPtr<Gio::File> & users_file, const bool debug, const bool separate_userhosts, const std::string & database_filename);
 
 	protected:
+		virtual std::set<std::string> _get_input_filenames();
+		virtual void _begin_file(const std::string & filename, const LogContents & contents);
 		virtual void _cleanup();
 		virtual void _handle_sessions(const std::vector<std::shared_ptr<Session>> & sessions);
 
@@ -44,11 +72,26 @@ class GenerateOperation : public Operation
 		void _initialize_database_tables();
 		void _initialize_database_indexes();
 		void _initialize_database_queries();
+		void _reset_database();
 
-		void _insert_nick_specification(std::list<std::pair<std::shared_ptr<const NickSpecification>, int>> & nick_specifications, const std::shared_ptr<const NickSpecification> & nick_specification, const int user_id);
+		void _load_target();
+		void _load_nickuserhosts();
+
+		void _finish_loading();
+
+		void _bind_event_row(SQLite::Statement & query, int column, const EventRow & row);
+		void _insert_event_rows();
+
+		void _record_activity(const int nickuserhost_id, const Event & event);
+		void _insert_activity();
+		void _rebuild_activity(const std::set<int> & nickuserhost_ids);
+		void _summarize_activity();
+
+		static void _sort_nick_specifications(std::vector<std::pair<std::shared_ptr<const NickSpecification>, int>> & nick_specifications);
 
 		void _load_users_file();
 		void _apply_users_file();
+		void _apply_timed_nick_specifications();
 		std::vector<std::shared_ptr<UserSpecification>> _parse_users_file() const;
 
 		Glib::RefPtr<Gio::File> _get_user_directory(const Glib::ustring & alias) const;
@@ -62,11 +105,13 @@ class GenerateOperation : public Operation
 		void _output_html_header(const Glib::RefPtr<Gio::DataOutputStream> & output_stream, const Glib::ustring & title, const Glib::ustring & media_prefix = "") const;
 		void _output_html_footer(const Glib::RefPtr<Gio::DataOutputStream> & output_stream) const;
 
-		void _output_html_user_index(const Glib::RefPtr<Gio::File> & user_file, const int user_id);
+		void _output_html_user_index(const UserPage & page) const;
+		void _output_html_user_indexes(const std::vector<UserPage> & pages) const;
 
 		void _output_html_section_overall_ranking(const Glib::RefPtr<Gio::DataOutputStream> & output_stream);
 
-		int _get_nickuserhost_id(const User & user);
+		int _get_nickuserhost_id(const User & user, gint64 timestamp);
+		int _get_copy_nickuserhost_id(const int source_id, const int user_id, const std::string & nickuserhost);
 
 		void _print_debug_info();
 
@@ -78,14 +123,40 @@ class GenerateOperation : public Operation
 		Glib::ustring _target;
 
 		SQLite::Database _database;
+		const bool _persistent;
 
 		std::shared_ptr<SQLite::Statement> _nickuserhost_insert_query;
+		std::shared_ptr<SQLite::Statement> _nickuserhost_copy_insert_query;
+		std::shared_ptr<SQLite::Statement> _event_insert_query;
+		std::shared_ptr<SQLite::Statement> _event_rows_insert_query;
+
+		std::unique_ptr<SQLite::Transaction> _transaction;
+		size_t _transaction_events;
+
+		int _file_id;
+		bool _file_target_recorded;
+
+		const std::string _users_file_checksum;
+		bool _users_file_changed;
+
+		std::vector<EventRow> _event_rows;
+		std::map<std::pair<int, gint64>, Activity> _activity;
+
+		EventStore _event_store;
+
+		std::vector<std::pair<std::shared_ptr<const NickSpecification>, int>> _timed_nick_specifications;
+		std::vector<std::pair<std::shared_ptr<const NickSpecification>, int>> _untimed_nick_specifications;
+
+		NickMatcher _timed_nick_matcher;
+		NickMatcher _untimed_nick_matcher;
 
-		std::list<std::pair<std::shared_ptr<const NickSpecification>, int>> _timed_nick_specifications;
-		std::list<std::pair<std::shared_ptr<const NickSpecification>, int>> _untimed_nick_specifications;
+		std::unordered_map<guint32, std::pair<guint32, guint32>> _userhosts;
+		std::unordered_map<guint32, int> _nickuserhost_ids;
+		std::unordered_map<std::string, int> _stored_nickuserhost_ids;
+		std::map<std::pair<int, int>, int> _copy_nickuserhost_ids;
+		std::unordered_map<int, std::vector<std::pair<std::shared_ptr<const TimeRange>, int>>> _timed_nickuserhost_ids;
 
-		std::unordered_map<std::string, std::string> _userhosts;
-		std::unordered_map<std::string, int> _nickuserhost_ids;
+		User::Cache _user_cache;
 
 		std::shared_ptr<const Glib::DateTime> _last_session_stop;
 
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_INTERN_TABLE_HH
+#define CHATSTATS_INTERN_TABLE_HH
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+class InternTable
+{
+	public:
+		const static guint32 CHUNK_BITS = 16;
+		const static guint32 CHUNK_SIZE = 1 << CHUNK_BITS;
+
+		class Cache
+		{
+			public:
+				const static size_t SIZE = 4096;
+
+				Cache() :
+					_slots(SIZE, std::make_pair(0, G_MAXUINT32))
+				{ }
+
+				template <typename K>
+				guint32 intern(InternTable & table, const K & key)
+				{
+					const size_t hash = Hash()(key);
+					auto & slot = this->_slots[hash % SIZE];
+
+					if (slot.first != hash || slot.second == G_MAXUINT32 || !Equal()(table.get(slot.second), key))
+						slot = std::make_pair(hash, table._intern(key, hash));
+
+					return slot.second;
+				}
+
+			private:
+				std::vector<std::pair<size_t, guint32>> _slots;
+		};
+
+		InternTable() :
+			_chunks(new std::atomic<T *>[CHUNK_SIZE]),
+			_size(0),
+			_index(64, std::make_pair(0, G_MAXUINT32))
+		{
+			for (guint32 i = 0; i < CHUNK_SIZE; i++)
+				this->_chunks[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		~InternTable()
+		{
+			for (guint32 id = 0; id < this->_size; id++)
+				this->_chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed)[id & (CHUNK_SIZE - 1)].~T();
+
+			for (guint32 i = 0; i < CHUNK_SIZE; i++)
+				::operator delete(this->_chunks[i].load(std::memory_order_relaxed));
+
+			delete[] this->_chunks;
+		}
+
+		InternTable(const InternTable &) = delete;
+		InternTable & operator=(const InternTable &) = delete;
+
+		template <typename K>
+		guint32 intern(const K & key)
+		{
+			return this->_intern(key, Hash()(key));
+		}
+
+		const T & get(guint32 id) const
+		{
+			return this->_chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+		}
+
+	private:
+		template <typename K>
+		guint32 _intern(const K & key, size_t hash)
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+
+			size_t mask = this->_index.size() - 1;
+
+			for (size_t i = hash & mask; this->_index[i].second != G_MAXUINT32; i = (i + 1) & mask)
+			{
+				if (this->_index[i].first == hash && Equal()(this->get(this->_index[i].second), key))
+					return this->_index[i].second;
+			}
+
+			const guint32 id = this->_size;
+			T * chunk = this->_chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+
+			if (!chunk)
+			{
+				chunk = static_cast<T *>(::operator new(sizeof(T) * CHUNK_SIZE));
+				this->_chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+			}
+
+			new (chunk + (id & (CHUNK_SIZE - 1))) T(key);
+			this->_size++;
+
+			if (this->_size * 2 > this->_index.size())
+			{
+				std::vector<std::pair<size_t, guint32>> index(this->_index.size() * 2, std::make_pair(0, G_MAXUINT32));
+				mask = index.size() - 1;
+
+				for (auto & entry : this->_index)
+				{
+					if (entry.second == G_MAXUINT32)
+						continue;
+
+					size_t i = entry.first & mask;
+
+					while (index[i].second != G_MAXUINT32)
+						i = (i + 1) & mask;
+
+					index[i] = entry;
+				}
+
+				this->_index.swap(index);
+			}
+
+			size_t i = hash & mask;
+
+			while (this->_index[i].second != G_MAXUINT32)
+				i = (i + 1) & mask;
+
+			this->_index[i] = std::make_pair(hash, id);
+
+			return id;
+		}
+
+		std::atomic<T *> * _chunks;
+		guint32 _size;
+
+		std::vector<std::pair<size_t, guint32>> _index;
+		std::mutex _mutex;
+};
+
+#endif // CHATSTATS_INTERN_TABLE_HH
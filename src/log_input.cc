@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+
+#include <glibmm/checksum.h>
+
+#include "encoding.hh"
+#include "log_input.hh"
+
+LogContents::LogContents(const Glib::RefPtr<Gio::File> & file) :
+	_path(file->get_path()),
+	_modification_time(0),
+	_mapped_file(nullptr),
+	_contents(nullptr),
+	_data(nullptr),
+	_length(0)
+{
+	const Glib::TimeVal modification_time = file->query_info("time::modified")->modification_time();
+	this->_modification_time = static_cast<gint64>(modification_time.tv_sec) * 1000000 + modification_time.tv_usec;
+
+	if (!this->_path.empty())
+		this->_mapped_file = g_mapped_file_new(this->_path.c_str(), FALSE, nullptr);
+
+	if (this->_mapped_file)
+	{
+		this->_data = g_mapped_file_get_contents(this->_mapped_file);
+		this->_length = g_mapped_file_get_length(this->_mapped_file);
+	}
+	else
+	{
+		std::string etag;
+
+		file->load_contents(this->_contents, this->_length, etag);
+
+		this->_data = this->_contents;
+	}
+}
+
+LogContents::~LogContents()
+{
+	if (this->_mapped_file)
+		g_mapped_file_unref(this->_mapped_file);
+
+	g_free(this->_contents);
+}
+
+const std::string & LogContents::get_path() const
+{
+	return this->_path;
+}
+
+gint64 LogContents::get_modification_time() const
+{
+	return this->_modification_time;
+}
+
+const char * LogContents::get_data() const
+{
+	return this->_data;
+}
+
+gsize LogContents::get_length() const
+{
+	return this->_length;
+}
+
+const std::string & LogContents::get_checksum() const
+{
+	if (this->_checksum.empty())
+	{
+		Glib::Checksum checksum(Glib::Checksum::CHECKSUM_SHA1);
+		checksum.update(reinterpret_cast<const guchar *>(this->_data), this->_length);
+
+		this->_checksum = checksum.get_string();
+	}
+
+	return this->_checksum;
+}
+
+LogInput::LogInput(const std::shared_ptr<const LogContents> & contents) :
+	_contents(contents),
+	_format(Decompressor::detect_format(_contents->get_data(), _contents->get_length())),
+	_begin(_contents->get_data()),
+	_position(_begin),
+	_end(_begin + _contents->get_length())
+{
+	if (this->_format != CompressionFormat::NONE)
+		this->rewind();
+}
+
+LogInput::LogInput(const std::shared_ptr<const LogContents> & contents, const char * begin, const char * end) :
+	_contents(contents),
+	_format(CompressionFormat::NONE),
+	_begin(begin),
+	_position(begin),
+	_end(end)
+{ }
+
+std::vector<std::shared_ptr<LogInput>> LogInput::split(unsigned int count) const
+{
+	const std::string boundary = "\nSession Start: ";
+
+	std::vector<std::shared_ptr<LogInput>> inputs;
+	const char * begin = this->_begin;
+
+	if (this->_format != CompressionFormat::NONE)
+		return inputs;
+
+	for (unsigned int i = 1; i < count; i++)
+	{
+		const char * target = this->_begin + (this->_end - this->_begin) * i / count;
+
+		if (target < begin)
+			continue;
+
+		const char * position = static_cast<const char *>(memmem(target, this->_end - target, boundary.data(), boundary.size()));
+
+		if (!position)
+			break;
+
+		inputs.push_back(std::make_shared<LogInput>(this->_contents, begin, position + 1));
+		begin = position + 1;
+	}
+
+	inputs.push_back(std::make_shared<LogInput>(this->_contents, begin, this->_end));
+
+	return inputs;
+}
+
+bool LogInput::read_line(const char * & data, gsize & length, Arena & arena)
+{
+	if (this->_position < this->_end || this->_next_block(arena))
+	{
+		const char * newline = static_cast<const char *>(memchr(this->_position, '\n', this->_end - this->_position));
+
+		data = this->_position;
+
+		if (newline)
+		{
+			length = newline - this->_position;
+			this->_position = newline + 1;
+		}
+		else if (this->_decompressor)
+		{
+			this->_read_spanning_line(data, length, arena);
+		}
+		else
+		{
+			length = this->_end - this->_position;
+			this->_position = this->_end;
+		}
+
+		if (!is_valid_utf8(data, length))
+			this->_transcode_line(data, length, arena);
+
+		return true;
+	}
+
+	return false;
+}
+
+void LogInput::retain(Arena & arena) const
+{
+	arena.retain(this->_contents);
+
+	if (this->_block)
+		arena.retain(this->_block);
+}
+
+void LogInput::rewind()
+{
+	if (this->_format == CompressionFormat::NONE)
+	{
+		this->_position = this->_begin;
+		return;
+	}
+
+	this->_decompressor.reset();
+	this->_block.reset();
+	this->_position = this->_end = nullptr;
+
+	this->_decompressor.reset(new Decompressor(this->_contents, this->_contents->get_data(), this->_contents->get_length(), this->_format));
+}
+
+bool LogInput::_next_block(Arena & arena)
+{
+	if (!this->_decompressor)
+		return false;
+
+	while (auto block = this->_decompressor->next_block())
+	{
+		if (block->empty())
+			continue;
+
+		this->_block = block;
+		arena.retain(block);
+
+		this->_position = block->data();
+		this->_end = block->data() + block->size();
+
+		return true;
+	}
+
+	this->_decompressor.reset();
+	this->_block.reset();
+
+	return false;
+}
+
+void LogInput::_read_spanning_line(const char * & data, gsize & length, Arena & arena)
+{
+	std::string & line = this->_line_buffer;
+	line.assign(this->_position, this->_end);
+
+	this->_position = this->_end;
+
+	while (this->_next_block(arena))
+	{
+		const char * newline = static_cast<const char *>(memchr(this->_position, '\n', this->_end - this->_position));
+
+		line.append(this->_position, newline ? newline : this->_end);
+		this->_position = newline ? newline + 1 : this->_end;
+
+		if (newline)
+			break;
+	}
+
+	data = arena.copy(line.data(), line.size());
+	length = line.size();
+}
+
+void LogInput::_transcode_line(const char * & data, gsize & length, Arena & arena)
+{
+	std::string & line = this->_line_buffer;
+	line.clear();
+
+	if (!append_cp1252_as_utf8(line, data, length))
+		append_latin1_as_utf8(line, data, length);
+
+	data = arena.copy(line.data(), line.size());
+	length = line.size();
+}
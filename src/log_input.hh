@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_LOG_INPUT_HH
+#define CHATSTATS_LOG_INPUT_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <giomm/file.h>
+
+#include "arena.hh"
+#include "decompressor.hh"
+
+class LogContents
+{
+	public:
+		LogContents(const Glib::RefPtr<Gio::File> & file);
+		~LogContents();
+
+		LogContents(const LogContents &) = delete;
+		LogContents & operator=(const LogContents &) = delete;
+
+		const std::string & get_path() const;
+		gint64 get_modification_time() const;
+
+		const char * get_data() const;
+		gsize get_length() const;
+
+		const std::string & get_checksum() const;
+
+	private:
+		std::string _path;
+		gint64 _modification_time;
+
+		GMappedFile * _mapped_file;
+		char * _contents;
+
+		const char * _data;
+		gsize _length;
+
+		mutable std::string _checksum;
+};
+
+class LogInput
+{
+	public:
+		LogInput(const std::shared_ptr<const LogContents> & contents);
+		LogInput(const std::shared_ptr<const LogContents> & contents, const char * begin, const char * end);
+
+		std::vector<std::shared_ptr<LogInput>> split(unsigned int count) const;
+
+		bool read_line(const char * & data, gsize & length, Arena & arena);
+		void retain(Arena & arena) const;
+		void rewind();
+
+	private:
+		bool _next_block(Arena & arena);
+		void _read_spanning_line(const char * & data, gsize & length, Arena & arena);
+		void _transcode_line(const char * & data, gsize & length, Arena & arena);
+
+		std::shared_ptr<const LogContents> _contents;
+		CompressionFormat _format;
+		std::unique_ptr<Decompressor> _decompressor;
+		std::shared_ptr<const std::string> _block;
+
+		const char * _begin;
+		const char * _position;
+		const char * _end;
+
+		std::string _line_buffer;
+};
+
+#endif // CHATSTATS_LOG_INPUT_HH
@@ -20,15 +20,19 @@
  * SOFTWARE.
  */
 
+#include <cstring>
+#include <exception>
 #include <list>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
-#include <glibmm/convert.h>
 #include <glibmm/datetime.h>
 #include <glibmm/timezone.h>
-#include <giomm/datainputstream.h>
 
 #include "log_reader.hh"
+#include "log_writer.hh"
+#include "util.hh"
 
 ChatstatsLogReader::ChatstatsLogReader()
 {
@@ -55,6 +59,239 @@ ChatstatsLogReader::ChatstatsLogReader()
 	this->_add_regex_event(EventType::KICK, "^\\[(?P<timestamp>[^\\]]*)\\] \\*\\*\\* (?P<subject_nick>[^ ]*) kicks (?P<object_nick>[^ ]*)( \\((?P<message>.*)\\))?$");
 }
 
+std::shared_ptr<LogReader> ChatstatsLogReader::clone() const
+{
+	return std::make_shared<ChatstatsLogReader>();
+}
+
+bool _scan_has_prefix(const char * begin, const char * end, const char * prefix)
+{
+	const size_t length = strlen(prefix);
+
+	return static_cast<size_t>(end - begin) >= length && memcmp(begin, prefix, length) == 0;
+}
+
+bool _scan_equals(const char * begin, const char * end, const char * string)
+{
+	return static_cast<size_t>(end - begin) == strlen(string) && _scan_has_prefix(begin, end, string);
+}
+
+const char * _scan_find(const char * begin, const char * end, char character)
+{
+	const char * position = static_cast<const char *>(memchr(begin, character, end - begin));
+
+	return position ? position : end;
+}
+
+bool _scan_parenthesized(const char * begin, const char * end, const char * & message_begin, const char * & message_end)
+{
+	message_begin = message_end = end;
+
+	if (begin == end)
+		return true;
+
+	if (end - begin < 3 || !_scan_has_prefix(begin, end, " (") || *(end - 1) != ')')
+		return false;
+
+	message_begin = begin + 2;
+	message_end = end - 1;
+
+	return true;
+}
+
+bool _fetch_named_range(Glib::MatchInfo & match_info, const Glib::ustring & name, const char * data, const char * & begin, const char * & end)
+{
+	int start_position = 0;
+	int end_position = 0;
+
+	if (!match_info.fetch_named_pos(name, start_position, end_position) || start_position < 0)
+	{
+		begin = end = data;
+		return false;
+	}
+
+	begin = data + start_position;
+	end = data + end_position;
+
+	return begin != end;
+}
+
+bool ChatstatsLogReader::_parse_line(const char * data, gsize length, Event & event)
+{
+	bool created = false;
+
+	if (this->_scan_line(data, data + length, event, created))
+		return created;
+
+	return LogReader::_parse_line(data, length, event);
+}
+
+bool ChatstatsLogReader::_scan_line(const char * begin, const char * end, Event & event, bool & created)
+{
+	for (const unsigned char * c = reinterpret_cast<const unsigned char *>(begin); c < reinterpret_cast<const unsigned char *>(end); c++)
+	{
+		if (*c >= '\n' && *c <= '\r')
+			return false;
+
+		if (*c == 0xC2 && c + 1 < reinterpret_cast<const unsigned char *>(end) && c[1] == 0x85)
+			return false;
+
+		if (*c == 0xE2 && c + 2 < reinterpret_cast<const unsigned char *>(end) && c[1] == 0x80 && (c[2] == 0xA8 || c[2] == 0xA9))
+			return false;
+	}
+
+	const User none(StringPool::EMPTY, StringPool::EMPTY, StringPool::EMPTY);
+
+	if (_scan_has_prefix(begin, end, "Session "))
+	{
+		const char * rest = begin + 8;
+
+		if (_scan_has_prefix(rest, end, "Start: "))
+			created = this->_create_event(event, EventType::PARSE_SESSION_START, rest + 7, end, none, none, end, end);
+		else if (_scan_has_prefix(rest, end, "Stop: "))
+			created = this->_create_event(event, EventType::PARSE_SESSION_STOP, rest + 6, end, none, none, end, end);
+		else if (_scan_has_prefix(rest, end, "Target: "))
+			created = this->_create_event(event, EventType::PARSE_SESSION_TARGET, end, end, none, none, rest + 8, end);
+		else
+			return false;
+
+		return true;
+	}
+
+	if (begin == end || *begin != '[')
+		return false;
+
+	const char * timestamp_end = _scan_find(begin + 1, end, ']');
+
+	if (end - timestamp_end < 3 || *(timestamp_end + 1) != ' ')
+		return false;
+
+	const char * timestamp_begin = begin + 1;
+	const char * rest = timestamp_end + 2;
+
+	if (_scan_has_prefix(rest, end, "*** "))
+		return this->_scan_server_line(timestamp_begin, timestamp_end, rest + 4, end, event, created);
+
+	if (_scan_has_prefix(rest, end, "* "))
+	{
+		const char * nick_end = _scan_find(rest + 2, end, ' ');
+		const char * message_begin = nick_end < end ? nick_end + 1 : end;
+
+		created = this->_create_event(event, EventType::ACTION, timestamp_begin, timestamp_end, User(this->_intern_string(rest + 2, nick_end), StringPool::EMPTY, StringPool::EMPTY), none, message_begin, end);
+
+		return true;
+	}
+
+	EventType type;
+	char close;
+
+	switch (*rest)
+	{
+		case '<':
+			type = EventType::MESSAGE;
+			close = '>';
+			break;
+		case '[':
+			type = EventType::CTCP;
+			close = ']';
+			break;
+		case '-':
+			type = EventType::NOTICE;
+			close = '-';
+			break;
+		default:
+			return false;
+	}
+
+	const char * nick_end = _scan_find(rest, end, ' ');
+
+	if (nick_end == end || nick_end - rest < 2 || *(nick_end - 1) != close)
+		return false;
+
+	created = this->_create_event(event, type, timestamp_begin, timestamp_end, User(this->_intern_string(rest + 1, nick_end - 1), StringPool::EMPTY, StringPool::EMPTY), none, nick_end + 1, end);
+
+	return true;
+}
+
+bool ChatstatsLogReader::_scan_server_line(const char * timestamp_begin, const char * timestamp_end, const char * begin, const char * end, Event & event, bool & created)
+{
+	const char * nick_end = _scan_find(begin, end, ' ');
+
+	if (nick_end == end)
+		return false;
+
+	const User none(StringPool::EMPTY, StringPool::EMPTY, StringPool::EMPTY);
+	const char * rest = nick_end + 1;
+
+	if (_scan_equals(rest, end, "joins") || _scan_has_prefix(rest, end, "parts") || _scan_has_prefix(rest, end, "quits"))
+	{
+		const EventType type = *rest == 'j' ? EventType::JOIN : (*rest == 'p' ? EventType::PART : EventType::QUIT);
+		const char * message_begin;
+		const char * message_end;
+
+		if (!_scan_parenthesized(rest + 5, end, message_begin, message_end))
+			return false;
+
+		const char * bang = _scan_find(begin, nick_end, '!');
+
+		if (bang == nick_end)
+		{
+			created = this->_create_event(event, type, timestamp_begin, timestamp_end, User(this->_intern_string(begin, nick_end), StringPool::EMPTY, StringPool::EMPTY), none, message_begin, message_end);
+			return true;
+		}
+
+		const char * at = nick_end - 1;
+
+		while (at > bang && *at != '@')
+			at--;
+
+		if (at == bang)
+			return false;
+
+		created = this->_create_event(event, type, timestamp_begin, timestamp_end, User(this->_intern_string(begin, bang), this->_intern_string(bang + 1, at), this->_intern_string(at + 1, nick_end)), none, message_begin, message_end);
+
+		return true;
+	}
+
+	const User subject(this->_intern_string(begin, nick_end), StringPool::EMPTY, StringPool::EMPTY);
+
+	if (_scan_has_prefix(rest, end, "is now known as "))
+	{
+		if (_scan_find(rest + 16, end, ' ') != end)
+			return false;
+
+		created = this->_create_event(event, EventType::NICK_CHANGE, timestamp_begin, timestamp_end, subject, User(this->_intern_string(rest + 16, end), StringPool::EMPTY, StringPool::EMPTY), end, end);
+	}
+	else if (_scan_has_prefix(rest, end, "sets mode: "))
+	{
+		created = this->_create_event(event, EventType::MODE_CHANGE, timestamp_begin, timestamp_end, subject, none, rest + 11, end);
+	}
+	else if (_scan_has_prefix(rest, end, "changes topic to '"))
+	{
+		if (end - rest < 19 || *(end - 1) != '\'')
+			return false;
+
+		created = this->_create_event(event, EventType::TOPIC_CHANGE, timestamp_begin, timestamp_end, subject, none, rest + 18, end - 1);
+	}
+	else if (_scan_has_prefix(rest, end, "kicks "))
+	{
+		const char * object_end = _scan_find(rest + 6, end, ' ');
+		const char * message_begin;
+		const char * message_end;
+
+		if (!_scan_parenthesized(object_end, end, message_begin, message_end))
+			return false;
+
+		created = this->_create_event(event, EventType::KICK, timestamp_begin, timestamp_end, subject, User(this->_intern_string(rest + 6, object_end), StringPool::EMPTY, StringPool::EMPTY), message_begin, message_end);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
 MircLogReader::MircLogReader()
 {
 	this->_regex_timestamp.push_back(Glib::Regex::create("^[A-Za-z]+ (?P<textmonth>[A-Za-z]+) (?P<day>[0-9]{1,2}) (?P<hour>[0-9]{2}):(?P<minute>[0-9]{2}):(?P<second>[0-9]{2}) (?P<year>[0-9]{4})$"));
@@ -82,110 +319,597 @@ MircLogReader::MircLogReader()
 	this->_add_regex_event(EventType::KICK, "^\\[(?P<timestamp>[^\\]]*)\\] \\*\\*\\* (?P<object_nick>[^ ]*) was kicked by (?P<subject_nick>[^ ]*)( \\((?P<message>.*)\\))?$");
 }
 
-std::vector<std::shared_ptr<Session>> LogReader::read(const Glib::RefPtr<Gio::File> & file)
+std::shared_ptr<LogReader> MircLogReader::clone() const
+{
+	return std::make_shared<MircLogReader>();
+}
+
+BinaryLogReader::BinaryLogReader() :
+	_position(nullptr),
+	_end(nullptr),
+	_remaining_sessions(0)
+{ }
+
+std::shared_ptr<LogReader> BinaryLogReader::clone() const
+{
+	return std::make_shared<BinaryLogReader>();
+}
+
+std::vector<std::shared_ptr<Session>> BinaryLogReader::read(const std::shared_ptr<const LogContents> & contents, unsigned int)
 {
 	std::vector<std::shared_ptr<Session>> sessions;
 
-	Glib::ustring target = "";
+	this->open(contents);
 
-	this->_warnings.clear();
-	this->_load_file_contents(file);
-	this->_iter = this->_lines.begin();
+	while (auto session = this->read_session())
+		sessions.push_back(session);
+
+	this->close();
+
+	return sessions;
+}
+
+void BinaryLogReader::open(const std::shared_ptr<const LogContents> & contents)
+{
+	const CompressionFormat format = Decompressor::detect_format(contents->get_data(), contents->get_length());
+
+	if (format == CompressionFormat::NONE)
+	{
+		this->_source = contents;
+		this->_position = contents->get_data();
+		this->_end = this->_position + contents->get_length();
+	}
+	else
+	{
+		auto data = std::make_shared<std::string>();
+		Decompressor decompressor(contents, contents->get_data(), contents->get_length(), format);
+
+		while (auto block = decompressor.next_block())
+			data->append(*block);
+
+		this->_source = data;
+		this->_position = data->data();
+		this->_end = this->_position + data->size();
+	}
+
+	const char * magic = this->_read_bytes(BinaryLogWriter::MAGIC.size());
+
+	guint32 version;
+	memcpy(&version, this->_read_bytes(sizeof(version)), sizeof(version));
+	version = GUINT32_FROM_LE(version);
+
+	if (memcmp(magic, BinaryLogWriter::MAGIC.data(), BinaryLogWriter::MAGIC.size()) != 0 || version != BinaryLogWriter::VERSION)
+		throw std::runtime_error(Glib::ustring::compose("Not a binary log file: %1", contents->get_path()));
+
+	this->_remaining_sessions = this->_read_varint();
+}
+
+std::shared_ptr<Session> BinaryLogReader::read_session()
+{
+	while (this->_remaining_sessions > 0)
+	{
+		this->_remaining_sessions--;
+
+		this->_arena = std::make_shared<Arena>(this->_source);
+
+		auto session = std::make_shared<Session>();
+
+		const guint64 target_length = this->_read_varint();
+		const char * target = this->_read_bytes(target_length);
+
+		session->target = Glib::ustring(target, target + target_length);
+
+		const gint64 start = this->_read_int64();
+		const gint64 stop = this->_read_int64();
+
+		session->start = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(start));
+		session->stop = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(stop));
+
+		for (guint64 i = 0, count = this->_read_varint(); i < count; i++)
+			this->_read_block(session);
+
+		if (!session->events.empty())
+		{
+			session->events.compact(this->_arena);
+			return session;
+		}
+	}
+
+	return nullptr;
+}
+
+void BinaryLogReader::close()
+{
+	this->_source.reset();
+	this->_arena.reset();
+
+	this->_position = nullptr;
+	this->_end = nullptr;
+	this->_remaining_sessions = 0;
+}
+
+void BinaryLogReader::_read_block(const std::shared_ptr<Session> & session)
+{
+	const guint64 count = this->_read_varint();
+	const gint64 first_timestamp = this->_read_int64();
+	this->_read_int64();
+	const guint64 body_length = this->_read_varint();
+
+	const char * body_end = this->_read_bytes(body_length) + body_length;
+	this->_position = body_end - body_length;
+
+	if (count > body_length)
+		throw std::runtime_error("Corrupt binary log file");
+
+	const guint64 string_count = this->_read_varint();
+
+	if (string_count > body_length)
+		throw std::runtime_error("Corrupt binary log file");
+
+	std::vector<guint32> strings(string_count);
+
+	for (guint32 & value : strings)
+	{
+		const guint64 length = this->_read_varint();
+		const char * data = this->_read_bytes(length);
+
+		value = this->_intern_string(data, data + length);
+	}
+
+	const char * types = this->_read_bytes(count);
+
+	std::vector<gint64> timestamps(count);
+	gint64 timestamp = first_timestamp;
+
+	for (gint64 & value : timestamps)
+	{
+		const guint64 delta = this->_read_varint();
+
+		timestamp += static_cast<gint64>(delta >> 1) ^ -static_cast<gint64>(delta & 1);
+		value = timestamp;
+	}
+
+	std::vector<guint64> users(count * 6);
+
+	for (guint64 & value : users)
+	{
+		value = this->_read_varint();
+
+		if (value >= strings.size())
+			throw std::runtime_error("Corrupt binary log file");
+	}
+
+	std::vector<guint64> message_lengths(count);
+
+	for (guint64 & value : message_lengths)
+		value = this->_read_varint();
+
+	for (guint64 i = 0; i < count; i++)
+	{
+		const char * message = this->_read_bytes(message_lengths[i]);
+		const guint8 type = static_cast<guint8>(types[i]);
+
+		if (type > static_cast<guint8>(EventType::PARSE_SESSION_TARGET))
+			throw std::runtime_error("Corrupt binary log file");
+
+		const guint64 * user = &users[i * 6];
+
+		const User subject(strings[user[0]], strings[user[1]], strings[user[2]]);
+		const User object(strings[user[3]], strings[user[4]], strings[user[5]]);
+
+		session->events.push_back(Event(static_cast<EventType>(type), timestamps[i], User::intern(this->_user_cache, subject), User::intern(this->_user_cache, object), message, message_lengths[i]));
+	}
+
+	if (this->_position != body_end)
+		throw std::runtime_error("Corrupt binary log file");
+}
+
+const char * BinaryLogReader::_read_bytes(gsize length)
+{
+	if (length > static_cast<gsize>(this->_end - this->_position))
+		throw std::runtime_error("Truncated binary log file");
+
+	const char * data = this->_position;
+	this->_position += length;
+
+	return data;
+}
+
+guint64 BinaryLogReader::_read_varint()
+{
+	guint64 value = 0;
+
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		const guint8 byte = static_cast<guint8>(*this->_read_bytes(1));
+		value |= static_cast<guint64>(byte & 0x7f) << shift;
+
+		if (!(byte & 0x80))
+			return value;
+	}
+
+	throw std::runtime_error("Corrupt binary log file");
+}
+
+gint64 BinaryLogReader::_read_int64()
+{
+	gint64 value;
+	memcpy(&value, this->_read_bytes(sizeof(value)), sizeof(value));
+
+	return GINT64_FROM_LE(value);
+}
+
+std::vector<std::shared_ptr<Session>> LogReader::read(const std::shared_ptr<const LogContents> & contents, unsigned int jobs)
+{
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	auto input = std::make_shared<LogInput>(contents);
+	auto inputs = input->split(jobs);
+
+	if (inputs.size() > 1)
+		sessions = this->_read_chunks(inputs);
+	else
+		sessions = this->_read_input(input, nullptr);
+
+	this->close();
 
-	while (this->_iter != this->_lines.end())
+	return sessions;
+}
+
+void LogReader::open(const std::shared_ptr<const LogContents> & contents)
+{
+	this->_begin_input(std::make_shared<LogInput>(contents), nullptr);
+}
+
+std::shared_ptr<Session> LogReader::read_session()
+{
+	while (this->_has_line)
 	{
+		this->_begin_arena();
+
 		auto session = std::make_shared<Session>();
-		session->target = target;
+		session->target = this->_target;
+
+		if (this->_chunked)
+			this->_session_targets.push_back(SessionTargets{session, {}});
 
 		this->_parse_next_session(session);
 
 		if (session->events.size() > 0)
 		{
-			if (target == "" && session->target != "")
-				target = session->target;
+			session->events.compact(this->_arena);
 
-			sessions.push_back(session);
+			if (this->_target == "" && session->target != "")
+				this->_target = session->target;
+
+			return session;
 		}
 	}
 
-	if (target == "")
-		this->_warnings.insert(std::make_pair(0, "No session target in file"));
+	return nullptr;
+}
 
-	return sessions;
+void LogReader::close()
+{
+	if (this->_target == "")
+		this->_warnings.add(0, WarningType::NO_SESSION_TARGET);
+
+	this->_input.reset();
+	this->_arena.reset();
 }
 
-const std::multimap<int, Glib::ustring> & LogReader::get_warnings() const
+const WarningList & LogReader::get_warnings() const
 {
 	return this->_warnings;
 }
 
-void LogReader::_load_file_contents(const Glib::RefPtr<Gio::File> & file)
+void LogReader::_begin_input(const std::shared_ptr<LogInput> & input, const std::shared_ptr<const Glib::DateTime> & previous_timestamp)
+{
+	this->_target = "";
+	this->_warnings.clear();
+	this->_current_timestamp = previous_timestamp;
+	this->_cached_timestamp.reset();
+	this->_first_timestamp.reset();
+	this->_first_timestamp_line = 0;
+	this->_missing_previous_timestamp = false;
+	this->_session_targets.clear();
+	this->_input = input;
+	this->_line_number = 0;
+	this->_has_line = false;
+	this->_begin_arena();
+	this->_next_line();
+}
+
+void LogReader::_begin_arena()
 {
-	const std::string encodings[] = {"UTF-8", "CP1252", "ISO-8859-1"};
+	auto arena = std::make_shared<Arena>();
+	this->_input->retain(*arena);
 
-	this->_lines.clear();
+	if (this->_has_line)
+		this->_line_data = arena->copy(this->_line_data, this->_line_length);
 
-	Glib::RefPtr<Gio::DataInputStream> file_stream = Gio::DataInputStream::create(file->read());
-	std::string line;
+	this->_arena = arena;
+}
 
-	while (file_stream->read_line(line))
+std::vector<std::shared_ptr<Session>> LogReader::_read_input(const std::shared_ptr<LogInput> & input, const std::shared_ptr<const Glib::DateTime> & previous_timestamp)
+{
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	this->_begin_input(input, previous_timestamp);
+
+	while (auto session = this->read_session())
+		sessions.push_back(session);
+
+	this->_input.reset();
+	this->_arena.reset();
+
+	return sessions;
+}
+
+std::vector<std::shared_ptr<Session>> LogReader::_read_chunks(const std::vector<std::shared_ptr<LogInput>> & inputs)
+{
+	std::vector<std::shared_ptr<LogReader>> readers;
+	std::vector<std::vector<std::shared_ptr<Session>>> results(inputs.size());
+	std::vector<std::exception_ptr> errors(inputs.size());
+	std::vector<std::thread> threads;
+
+	for (size_t i = 0; i < inputs.size(); i++)
 	{
-		for (const std::string & encoding : encodings)
+		readers.push_back(this->clone());
+		readers.back()->_chunked = true;
+
+		threads.push_back(std::thread([&, i]()
 		{
 			try
 			{
-				this->_lines.push_back(Glib::convert(line, "UTF-8", encoding));
-				break;
+				results[i] = readers[i]->_read_input(inputs[i], nullptr);
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+			}
+		}));
+	}
+
+	for (auto & thread : threads)
+		thread.join();
+
+	for (auto & error : errors)
+		if (error)
+			std::rethrow_exception(error);
+
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	this->_target = "";
+	this->_warnings.clear();
+	this->_current_timestamp.reset();
+
+	int line_offset = 0;
+
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		auto & reader = readers[i];
+
+		if (reader->_missing_previous_timestamp && this->_current_timestamp)
+		{
+			inputs[i]->rewind();
+			results[i] = reader->_read_input(inputs[i], this->_current_timestamp);
+		}
+		else if (reader->_first_timestamp && this->_current_timestamp && reader->_first_timestamp->to_unix() < this->_current_timestamp->to_unix())
+		{
+			WarningList warnings;
+
+			warnings.add(reader->_first_timestamp_line, WarningType::TIMESTAMP_BACKWARDS);
+			warnings.merge(reader->_warnings, 0);
+
+			reader->_warnings = warnings;
+		}
+
+		this->_warnings.merge(reader->_warnings, line_offset);
+
+		for (auto & session_targets : reader->_session_targets)
+		{
+			Glib::ustring target = this->_target;
+
+			for (auto & line : session_targets.lines)
+			{
+				if (target == "")
+					target = line.second;
+				else if (target != line.second)
+					this->_warnings.add(line.first + line_offset, WarningType::MULTIPLE_SESSION_TARGETS);
 			}
-			catch (Glib::ConvertError e) {}
+
+			session_targets.session->target = target;
+
+			if (this->_target == "" && !session_targets.session->events.empty())
+				this->_target = target;
 		}
+
+		reader->_session_targets.clear();
+
+		sessions.insert(sessions.end(), results[i].begin(), results[i].end());
+
+		if (reader->_current_timestamp)
+			this->_current_timestamp = reader->_current_timestamp;
+
+		line_offset += reader->_line_number;
 	}
+
+	return sessions;
 }
 
-std::shared_ptr<const Event> LogReader::_parse_line(const Glib::ustring & line)
+bool LogReader::_next_line()
 {
-	Glib::MatchInfo match_info;
+	this->_has_line = this->_input->read_line(this->_line_data, this->_line_length, *this->_arena);
+
+	if (this->_has_line)
+		this->_line_number++;
+
+	return this->_has_line;
+}
 
+bool LogReader::_parse_line(const char * data, gsize length, Event & event)
+{
 	for (auto & regex : this->_regex_event)
 	{
-		if (regex.second->match(line, match_info))
-		{
-			std::shared_ptr<const Glib::DateTime> timestamp = this->_parse_timestamp(match_info.fetch_named("timestamp"));
+		GMatchInfo * raw_match_info = nullptr;
+		const bool matched = g_regex_match_full(regex.second->gobj(), data, length, 0, static_cast<GRegexMatchFlags>(0), &raw_match_info, nullptr);
+		Glib::MatchInfo match_info(raw_match_info);
 
-			if (!timestamp && regex.first != EventType::PARSE_SESSION_TARGET && regex.first != EventType::PARSE_IGNORE)
+		if (matched)
+		{
+			const char * begin;
+			const char * end;
+
+			_fetch_named_range(match_info, "subject_nick", data, begin, end);
+			const guint32 subject_nick = this->_intern_string(begin, end);
+			_fetch_named_range(match_info, "subject_user", data, begin, end);
+			const guint32 subject_user = this->_intern_string(begin, end);
+			_fetch_named_range(match_info, "subject_host", data, begin, end);
+			const guint32 subject_host = this->_intern_string(begin, end);
+			_fetch_named_range(match_info, "object_nick", data, begin, end);
+			const guint32 object_nick = this->_intern_string(begin, end);
+			_fetch_named_range(match_info, "object_user", data, begin, end);
+			const guint32 object_user = this->_intern_string(begin, end);
+			_fetch_named_range(match_info, "object_host", data, begin, end);
+			const guint32 object_host = this->_intern_string(begin, end);
+
+			const char * message_begin;
+			const char * message_end;
+
+			_fetch_named_range(match_info, "message", data, message_begin, message_end);
+
+			if (_fetch_named_range(match_info, "message_extra", data, begin, end))
 			{
-				this->_add_warning("Invalid or missing timestamp");
-				return nullptr;
+				const std::string message = std::string(message_begin, message_end) + ' ' + std::string(begin, end);
+
+				message_begin = this->_arena->copy(message.data(), message.size());
+				message_end = message_begin + message.size();
 			}
 
-			if ((regex.first != EventType::PARSE_IGNORE && regex.first != EventType::PARSE_SESSION_START && regex.first != EventType::PARSE_SESSION_STOP  && regex.first != EventType::PARSE_SESSION_TARGET) && match_info.fetch_named("subject_nick").empty())
-				this->_add_warning("Empty subject nickname");
+			const char * timestamp_begin;
+			const char * timestamp_end;
 
-			if ((regex.first == EventType::KICK || regex.first == EventType::NICK_CHANGE) && match_info.fetch_named("object_nick").empty())
-				this->_add_warning("Empty object nickname");
+			_fetch_named_range(match_info, "timestamp", data, timestamp_begin, timestamp_end);
 
-			User subject(match_info.fetch_named("subject_nick"), match_info.fetch_named("subject_user"), match_info.fetch_named("subject_host"));
-			User object(match_info.fetch_named("object_nick"), match_info.fetch_named("object_user"), match_info.fetch_named("object_host"));
+			return this->_create_event(event, regex.first, timestamp_begin, timestamp_end, User(subject_nick, subject_user, subject_host), User(object_nick, object_user, object_host), message_begin, message_end);
+		}
+	}
 
-			Glib::ustring message = match_info.fetch_named("message");
+	return false;
+}
 
-			if (match_info.fetch_named("message_extra") != "")
-				message = Glib::ustring::compose("\1 \2", message, match_info.fetch_named("message_extra"));
+bool LogReader::_create_event(Event & event, EventType type, const char * timestamp_begin, const char * timestamp_end, const User & subject, const User & object, const char * message_begin, const char * message_end)
+{
+	std::shared_ptr<const Glib::DateTime> timestamp = this->_parse_timestamp(timestamp_begin, timestamp_end - timestamp_begin);
 
-			return std::make_shared<const Event>(regex.first, timestamp, subject, object, message);
-		}
+	if (timestamp && !this->_first_timestamp)
+	{
+		this->_first_timestamp = timestamp;
+		this->_first_timestamp_line = this->_line_number;
 	}
 
-	return nullptr;
+	if (!timestamp && type != EventType::PARSE_SESSION_TARGET && type != EventType::PARSE_IGNORE)
+	{
+		this->_add_warning(WarningType::INVALID_TIMESTAMP);
+		return false;
+	}
+
+	if ((type != EventType::PARSE_IGNORE && type != EventType::PARSE_SESSION_START && type != EventType::PARSE_SESSION_STOP  && type != EventType::PARSE_SESSION_TARGET) && subject.nick == StringPool::EMPTY)
+		this->_add_warning(WarningType::EMPTY_SUBJECT_NICKNAME);
+
+	if ((type == EventType::KICK || type == EventType::NICK_CHANGE) && object.nick == StringPool::EMPTY)
+		this->_add_warning(WarningType::EMPTY_OBJECT_NICKNAME);
+
+	event = Event(type, timestamp ? timestamp->to_unix() : 0, User::intern(this->_user_cache, subject), User::intern(this->_user_cache, object), message_begin, message_end - message_begin);
+
+	return true;
 }
 
-std::shared_ptr<const Glib::DateTime> LogReader::_parse_timestamp(const Glib::ustring & data)
+int _decode_digits(const char * data, int count)
 {
-	Glib::MatchInfo match_info;
+	int value = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (data[i] < '0' || data[i] > '9')
+			return -1;
+
+		value = value * 10 + (data[i] - '0');
+	}
+
+	return value;
+}
+
+std::shared_ptr<const Glib::DateTime> LogReader::_decode_timestamp(const char * data, gsize length)
+{
+	static const int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+	if (length != 24 || data[4] != '-' || data[7] != '-' || data[10] != ' ' || data[13] != ':' || data[16] != ':' || (data[19] != '+' && data[19] != '-'))
+		return nullptr;
+
+	if (!this->_cached_offset_string.empty() && memcmp(data + 19, this->_cached_offset_string.data(), 5) != 0)
+		this->_cached_offset_string.clear();
+
+	if (this->_cached_offset_string.empty())
+	{
+		const int offset_hours = _decode_digits(data + 20, 2);
+		const int offset_minutes = _decode_digits(data + 22, 2);
+
+		if (offset_hours < 0 || offset_hours > 23 || offset_minutes < 0 || offset_minutes > 59)
+			return nullptr;
+
+		this->_cached_offset_string.assign(data + 19, 5);
+		this->_cached_offset = (data[19] == '-' ? -1 : 1) * (offset_hours * 3600 + offset_minutes * 60);
+	}
+
+	const int year = _decode_digits(data, 4);
+	const int month = _decode_digits(data + 5, 2);
+	const int day = _decode_digits(data + 8, 2);
+	const int hour = _decode_digits(data + 11, 2);
+	const int minute = _decode_digits(data + 14, 2);
+	const int second = _decode_digits(data + 17, 2);
+
+	if (year < 1 || month < 1 || month > 12 || day < 1 || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59)
+		return nullptr;
+
+	const bool leap_year = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+	if (day > days_in_month[month - 1] + (month == 2 && leap_year ? 1 : 0))
+		return nullptr;
+
+	const gint64 unix_time = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - this->_cached_offset;
+	const gint64 previous_unix_time = this->_current_timestamp ? this->_current_timestamp->to_unix() : -this->_cached_offset;
+
+	auto timestamp = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(unix_time));
+
+	if (unix_time < previous_unix_time)
+		this->_add_warning(WarningType::TIMESTAMP_BACKWARDS);
+
+	this->_current_timestamp = timestamp;
+	this->_cached_timestamp = timestamp;
+	this->_cached_timestamp_string.assign(data, length);
+
+	return timestamp;
+}
+
+std::shared_ptr<const Glib::DateTime> LogReader::_parse_timestamp(const char * data, gsize length)
+{
+	if (this->_current_timestamp && this->_current_timestamp == this->_cached_timestamp && length == this->_cached_timestamp_string.size() && memcmp(data, this->_cached_timestamp_string.data(), length) == 0)
+		return this->_current_timestamp;
+
+	std::shared_ptr<const Glib::DateTime> decoded_timestamp = this->_decode_timestamp(data, length);
+
+	if (decoded_timestamp)
+		return decoded_timestamp;
 
 	for (auto & regex : this->_regex_timestamp)
 	{
-		if (regex->match(data, match_info))
+		GMatchInfo * raw_match_info = nullptr;
+		const bool matched = g_regex_match_full(regex->gobj(), data, length, 0, static_cast<GRegexMatchFlags>(0), &raw_match_info, nullptr);
+		Glib::MatchInfo match_info(raw_match_info);
+
+		if (matched)
 		{
 			Glib::ustring offset = match_info.fetch_named("offset");
 			Glib::TimeZone timezone = offset.empty() ? Glib::TimeZone::create_local() : Glib::TimeZone::create(offset);
@@ -198,7 +922,8 @@ std::shared_ptr<const Glib::DateTime> LogReader::_parse_timestamp(const Glib::us
 			}
 			else if (match_info.fetch_named("year").empty() || (match_info.fetch_named("month").empty() && match_info.fetch_named("textmonth").empty()) || match_info.fetch_named("day").empty())
 			{
-				this->_add_warning("Partial timestamp used before complete timestamp");
+				this->_add_warning(WarningType::PARTIAL_TIMESTAMP);
+				this->_missing_previous_timestamp = true;
 				return nullptr;
 			}
 
@@ -227,7 +952,7 @@ std::shared_ptr<const Glib::DateTime> LogReader::_parse_timestamp(const Glib::us
 				else if (textmonth == "Dec") month = 12;
 				else
 				{
-					this->_add_warning(Glib::ustring::compose("Invalid month name in timestamp: %1", textmonth));
+					this->_add_warning(WarningType::INVALID_MONTH_NAME, textmonth.data(), textmonth.data() + textmonth.bytes());
 					return nullptr;
 				}
 			}
@@ -235,7 +960,7 @@ std::shared_ptr<const Glib::DateTime> LogReader::_parse_timestamp(const Glib::us
 			auto timestamp = std::make_shared<const Glib::DateTime>(Glib::DateTime::create(timezone, year, month, day, hour, minute, second).to_utc());
 
 			if (timestamp->to_unix() < previous_timestamp.to_unix())
-				this->_add_warning("Timestamp is earlier than the previous timestamp");
+				this->_add_warning(WarningType::TIMESTAMP_BACKWARDS);
 
 			this->_current_timestamp = timestamp;
 
@@ -254,9 +979,19 @@ int LogReader::_parse_timestamp_int(const Glib::ustring & data, int default_valu
 		return stol(data.raw());
 }
 
-void LogReader::_add_warning(const Glib::ustring & warning)
+void LogReader::_add_warning(WarningType type)
+{
+	this->_warnings.add(this->_line_number, type);
+}
+
+void LogReader::_add_warning(WarningType type, const char * detail_begin, const char * detail_end)
 {
-	this->_warnings.insert(std::make_pair(this->_iter - this->_lines.begin() + 1, warning));
+	this->_warnings.add(this->_line_number, type, detail_begin, detail_end);
+}
+
+guint32 LogReader::_intern_string(const char * begin, const char * end)
+{
+	return StringPool::intern(this->_string_cache, begin, end - begin);
 }
 
 void LogReader::_add_regex_event(EventType type, const Glib::ustring & regex_string)
@@ -266,42 +1001,42 @@ void LogReader::_add_regex_event(EventType type, const Glib::ustring & regex_str
 
 void LogReader::_parse_next_session(const std::shared_ptr<Session> & session)
 {
-	for (; this->_iter != this->_lines.end(); this->_iter++)
+	for (; this->_has_line; this->_next_line())
 	{
-		auto line = *(this->_iter);
-
-		if (!line.empty())
+		if (this->_line_length > 0)
 		{
-			auto event = this->_parse_line(line);
+			Event event;
 
-			if (event)
+			if (this->_parse_line(this->_line_data, this->_line_length, event))
 			{
-				if (event->type == EventType::PARSE_SESSION_START)
+				if (event.type == EventType::PARSE_SESSION_START)
 				{
 					if (session->events.size() == 0)
 					{
-						session->start = event->timestamp;
+						session->start = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(event.timestamp));
 					}
 					else
 					{
 						break;
 					}
 				}
-				else if (event->type == EventType::PARSE_SESSION_STOP)
+				else if (event.type == EventType::PARSE_SESSION_STOP)
 				{
-					session->stop = event->timestamp;
+					session->stop = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(event.timestamp));
 
-					this->_iter++;
+					this->_next_line();
 					break;
 				}
-				else if (event->type == EventType::PARSE_SESSION_TARGET)
+				else if (event.type == EventType::PARSE_SESSION_TARGET)
 				{
-					if (session->target == "")
-						session->target = event->message.lowercase();
-					else if (session->target != event->message.lowercase())
-						this->_add_warning("Multiple session targets defined");
+					if (this->_chunked)
+						this->_session_targets.back().lines.push_back(std::make_pair(this->_line_number, event.get_message().lowercase()));
+					else if (session->target == "")
+						session->target = event.get_message().lowercase();
+					else if (session->target != event.get_message().lowercase())
+						this->_add_warning(WarningType::MULTIPLE_SESSION_TARGETS);
 				}
-				else if (event->type == EventType::PARSE_IGNORE)
+				else if (event.type == EventType::PARSE_IGNORE)
 				{
 
 				}
@@ -312,7 +1047,7 @@ void LogReader::_parse_next_session(const std::shared_ptr<Session> & session)
 			}
 			else
 			{
-				this->_add_warning(Glib::ustring::compose("Unrecognized line: %1", line));
+				this->_add_warning(WarningType::UNRECOGNIZED_LINE, this->_line_data, this->_line_data + this->_line_length);
 			}
 		}
 	}
@@ -321,12 +1056,12 @@ void LogReader::_parse_next_session(const std::shared_ptr<Session> & session)
 	{
 		if (!session->start)
 		{
-			session->start = session->events.front()->timestamp;
+			session->start = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(session->events.front().timestamp));
 		}
 
 		if (!session->stop)
 		{
-			session->stop = session->events.back()->timestamp;
+			session->stop = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(session->events.back().timestamp));
 		}
 	}
 }
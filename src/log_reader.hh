@@ -25,23 +25,34 @@
 
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glibmm/regex.h>
 #include <glibmm/ustring.h>
 #include <giomm/file.h>
 
+#include "arena.hh"
 #include "event.hh"
+#include "log_input.hh"
 #include "session.hh"
+#include "warning_list.hh"
 
 class LogReader
 {
 	public:
+		LogReader() : _chunked(false) { };
 		virtual ~LogReader() { };
 
-		std::vector<std::shared_ptr<Session>> read(const Glib::RefPtr<Gio::File> & file);
+		virtual std::shared_ptr<LogReader> clone() const = 0;
 
-		const std::multimap<int, Glib::ustring> & get_warnings() const;
+		virtual std::vector<std::shared_ptr<Session>> read(const std::shared_ptr<const LogContents> & contents, unsigned int jobs = 1);
+
+		virtual void open(const std::shared_ptr<const LogContents> & contents);
+		virtual std::shared_ptr<Session> read_session();
+		virtual void close();
+
+		const WarningList & get_warnings() const;
 
 	protected:
 		std::vector<std::pair<EventType, Glib::RefPtr<Glib::Regex>>> _regex_event;
@@ -50,35 +61,114 @@ class LogReader
 	protected:
 		void _add_regex_event(EventType type, const Glib::ustring & regex_string);
 
-	private:
-		void _load_file_contents(const Glib::RefPtr<Gio::File> & file);
+		virtual bool _parse_line(const char * data, gsize length, Event & event);
+		bool _create_event(Event & event, EventType type, const char * timestamp_begin, const char * timestamp_end, const User & subject, const User & object, const char * message_begin, const char * message_end);
+
+		guint32 _intern_string(const char * begin, const char * end);
 
-		std::shared_ptr<const Event> _parse_line(const Glib::ustring & line);
-		std::shared_ptr<const Glib::DateTime> _parse_timestamp(const Glib::ustring & data);
+		std::shared_ptr<Arena> _arena;
+
+		StringPool::Cache _string_cache;
+		User::Cache _user_cache;
+
+	private:
+		class SessionTargets
+		{
+			public:
+				std::shared_ptr<Session> session;
+				std::vector<std::pair<int, Glib::ustring>> lines;
+		};
+
+		void _begin_input(const std::shared_ptr<LogInput> & input, const std::shared_ptr<const Glib::DateTime> & previous_timestamp);
+		void _begin_arena();
+		std::vector<std::shared_ptr<Session>> _read_input(const std::shared_ptr<LogInput> & input, const std::shared_ptr<const Glib::DateTime> & previous_timestamp);
+		std::vector<std::shared_ptr<Session>> _read_chunks(const std::vector<std::shared_ptr<LogInput>> & inputs);
+
+		bool _next_line();
+
+		std::shared_ptr<const Glib::DateTime> _parse_timestamp(const char * data, gsize length);
+		std::shared_ptr<const Glib::DateTime> _decode_timestamp(const char * data, gsize length);
 		int _parse_timestamp_int(const Glib::ustring & data, int default_value);
 
-		void _add_warning(const Glib::ustring & warning);
+		void _add_warning(WarningType type);
+		void _add_warning(WarningType type, const char * detail_begin, const char * detail_end);
 
 		void _parse_next_session(const std::shared_ptr<Session> & session);
 
-		std::vector<Glib::ustring> _lines;
-		std::vector<Glib::ustring>::const_iterator _iter;
+		std::shared_ptr<LogInput> _input;
+
+		bool _chunked;
+		std::vector<SessionTargets> _session_targets;
+
+		const char * _line_data;
+		gsize _line_length;
+		bool _has_line;
+		int _line_number;
+
+		Glib::ustring _target;
 
 		std::shared_ptr<const Glib::DateTime> _current_timestamp;
+		std::shared_ptr<const Glib::DateTime> _first_timestamp;
+		int _first_timestamp_line;
+		bool _missing_previous_timestamp;
+
+		std::shared_ptr<const Glib::DateTime> _cached_timestamp;
+		std::string _cached_timestamp_string;
+
+		std::string _cached_offset_string;
+		int _cached_offset;
 
-		std::multimap<int, Glib::ustring> _warnings;
+		WarningList _warnings;
 };
 
 class ChatstatsLogReader : public LogReader
 {
 	public:
 		ChatstatsLogReader();
+
+		virtual std::shared_ptr<LogReader> clone() const;
+
+	protected:
+		virtual bool _parse_line(const char * data, gsize length, Event & event);
+
+	private:
+		bool _scan_line(const char * begin, const char * end, Event & event, bool & created);
+		bool _scan_server_line(const char * timestamp_begin, const char * timestamp_end, const char * begin, const char * end, Event & event, bool & created);
 };
 
 class MircLogReader : public LogReader
 {
 	public:
 		MircLogReader();
+
+		virtual std::shared_ptr<LogReader> clone() const;
+};
+
+class BinaryLogReader : public LogReader
+{
+	public:
+		BinaryLogReader();
+
+		virtual std::shared_ptr<LogReader> clone() const;
+
+		virtual std::vector<std::shared_ptr<Session>> read(const std::shared_ptr<const LogContents> & contents, unsigned int jobs = 1);
+
+		virtual void open(const std::shared_ptr<const LogContents> & contents);
+		virtual std::shared_ptr<Session> read_session();
+		virtual void close();
+
+	private:
+		void _read_block(const std::shared_ptr<Session> & session);
+
+		const char * _read_bytes(gsize length);
+		guint64 _read_varint();
+		gint64 _read_int64();
+
+		std::shared_ptr<const void> _source;
+
+		const char * _position;
+		const char * _end;
+		guint64 _remaining_sessions;
 };
 
 
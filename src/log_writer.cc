@@ -20,15 +20,76 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
 
 #include <giomm/dataoutputstream.h>
 
 #include "log_writer.hh"
 
-const Glib::ustring LogWriter::TIMESTAMP_FORMAT = "%Y-%m-%d %H:%M:%S+0000";
+const Glib::ustring ChatstatsLogWriter::TIMESTAMP_FORMAT = "%Y-%m-%d %H:%M:%S+0000";
 
-void LogWriter::write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions)
+const std::string BinaryLogWriter::MAGIC("CSBINLOG", 8);
+const guint32 BinaryLogWriter::VERSION = 1;
+const size_t BinaryLogWriter::BLOCK_SIZE = 4096;
+
+static void _put_uint32(std::string & output, guint32 value)
+{
+	value = GUINT32_TO_LE(value);
+	output.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void _put_int64(std::string & output, gint64 value)
+{
+	value = GINT64_TO_LE(value);
+	output.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void _put_varint(std::string & output, guint64 value)
+{
+	while (value >= 0x80)
+	{
+		output.push_back(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+
+	output.push_back(static_cast<char>(value));
+}
+
+static void _put_string(std::string & output, const std::string & value)
+{
+	_put_varint(output, value.size());
+	output.append(value);
+}
+
+static bool _is_written_event(EventType type)
+{
+	switch (type)
+	{
+		case EventType::ACTION:
+		case EventType::CTCP:
+		case EventType::JOIN:
+		case EventType::KICK:
+		case EventType::MESSAGE:
+		case EventType::MODE_CHANGE:
+		case EventType::NICK_CHANGE:
+		case EventType::NOTICE:
+		case EventType::PART:
+		case EventType::QUIT:
+		case EventType::TOPIC_CHANGE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+Glib::ustring ChatstatsLogWriter::get_extension() const
+{
+	return "log";
+}
+
+void ChatstatsLogWriter::write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions)
 {
 	Glib::RefPtr<Gio::DataOutputStream> file_stream = Gio::DataOutputStream::create(file->create_file());
 
@@ -44,11 +105,11 @@ void LogWriter::write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<
 		if (!session->target.empty())
 			file_stream->put_string(Glib::ustring::compose("%1\n", this->_format_session_target(session->target)).raw());
 
-		for (auto event : session->events)
+		for (auto & event : session->events)
 		{
 			Glib::ustring message;
 
-			switch (event->type)
+			switch (event.type)
 			{
 				case EventType::ACTION:
 					message = this->_format_action(event);
@@ -96,78 +157,207 @@ void LogWriter::write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<
 	}
 }
 
-Glib::ustring LogWriter::_format_session_start(std::shared_ptr<const Glib::DateTime> timestamp)
+Glib::ustring ChatstatsLogWriter::_format_timestamp(gint64 timestamp)
 {
-	return Glib::ustring::compose("Session Start: %1", timestamp->format(LogWriter::TIMESTAMP_FORMAT));
+	return Glib::DateTime::create_now_utc(timestamp).format(ChatstatsLogWriter::TIMESTAMP_FORMAT);
 }
 
-Glib::ustring LogWriter::_format_session_stop(std::shared_ptr<const Glib::DateTime> timestamp)
+Glib::ustring ChatstatsLogWriter::_format_session_start(std::shared_ptr<const Glib::DateTime> timestamp)
 {
-	return Glib::ustring::compose("Session Stop: %1", timestamp->format(LogWriter::TIMESTAMP_FORMAT));
+	return Glib::ustring::compose("Session Start: %1", timestamp->format(ChatstatsLogWriter::TIMESTAMP_FORMAT));
 }
 
-Glib::ustring LogWriter::_format_session_target(const Glib::ustring & target)
+Glib::ustring ChatstatsLogWriter::_format_session_stop(std::shared_ptr<const Glib::DateTime> timestamp)
+{
+	return Glib::ustring::compose("Session Stop: %1", timestamp->format(ChatstatsLogWriter::TIMESTAMP_FORMAT));
+}
+
+Glib::ustring ChatstatsLogWriter::_format_session_target(const Glib::ustring & target)
 {
 	return Glib::ustring::compose("Session Target: %1", target);
 }
 
-Glib::ustring LogWriter::_format_action(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_action(const Event & event)
 {
-	return Glib::ustring::compose("[%1] * %2 %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	return Glib::ustring::compose("[%1] * %2 %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_ctcp(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_ctcp(const Event & event)
 {
-	return Glib::ustring::compose("[%1] [%2] %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	return Glib::ustring::compose("[%1] [%2] %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_join(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_join(const Event & event)
 {
-	return Glib::ustring::compose("[%1] *** %2 joins", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string());
+	return Glib::ustring::compose("[%1] *** %2 joins", this->_format_timestamp(event.timestamp), event.get_subject().to_string());
 }
 
-Glib::ustring LogWriter::_format_kick(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_kick(const Event & event)
 {
-	return Glib::ustring::compose("[%1] *** %2 kicks %3 (%4)", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->object.to_string(), event->message);
+	return Glib::ustring::compose("[%1] *** %2 kicks %3 (%4)", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_object().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_message(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_message(const Event & event)
 {
-	return Glib::ustring::compose("[%1] <%2> %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	return Glib::ustring::compose("[%1] <%2> %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_mode_change(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_mode_change(const Event & event)
 {
-	return Glib::ustring::compose("[%1] *** %2 sets mode: %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	return Glib::ustring::compose("[%1] *** %2 sets mode: %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_nick_change(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_nick_change(const Event & event)
 {
-	return Glib::ustring::compose("[%1] *** %2 is now known as %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->object.to_string());
+	return Glib::ustring::compose("[%1] *** %2 is now known as %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_object().to_string());
 }
 
-Glib::ustring LogWriter::_format_notice(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_notice(const Event & event)
 {
-	return Glib::ustring::compose("[%1] -%2- %3", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	return Glib::ustring::compose("[%1] -%2- %3", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_part(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_part(const Event & event)
 {
-	if (event->message.empty())
-		return Glib::ustring::compose("[%1] *** %2 parts", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string());
+	if (event.message_length == 0)
+		return Glib::ustring::compose("[%1] *** %2 parts", this->_format_timestamp(event.timestamp), event.get_subject().to_string());
 	else
-		return Glib::ustring::compose("[%1] *** %2 parts (%3)", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+		return Glib::ustring::compose("[%1] *** %2 parts (%3)", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
 }
 
-Glib::ustring LogWriter::_format_quit(const std::shared_ptr<const Event> & event)
+Glib::ustring ChatstatsLogWriter::_format_quit(const Event & event)
 {
-	if (event->message.empty())
-		return Glib::ustring::compose("[%1] *** %2 quits", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string());
+	if (event.message_length == 0)
+		return Glib::ustring::compose("[%1] *** %2 quits", this->_format_timestamp(event.timestamp), event.get_subject().to_string());
 	else
-		return Glib::ustring::compose("[%1] *** %2 quits (%3)", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+		return Glib::ustring::compose("[%1] *** %2 quits (%3)", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
+}
+
+Glib::ustring ChatstatsLogWriter::_format_topic_change(const Event & event)
+{
+	return Glib::ustring::compose("[%1] *** %2 changes topic to '%3'", this->_format_timestamp(event.timestamp), event.get_subject().to_string(), event.get_message());
+}
+
+Glib::ustring BinaryLogWriter::get_extension() const
+{
+	return "bin";
 }
 
-Glib::ustring LogWriter::_format_topic_change(const std::shared_ptr<const Event> & event)
+void BinaryLogWriter::write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions)
 {
-	return Glib::ustring::compose("[%1] *** %2 changes topic to '%3'", event->timestamp->format(LogWriter::TIMESTAMP_FORMAT), event->subject.to_string(), event->message);
+	std::string output(BinaryLogWriter::MAGIC);
+	_put_uint32(output, BinaryLogWriter::VERSION);
+	_put_varint(output, sessions.size());
+
+	for (auto session : sessions)
+		this->_write_session(output, session);
+
+	gsize bytes_written;
+
+	Glib::RefPtr<Gio::FileOutputStream> file_stream = file->create_file();
+	file_stream->write_all(output, bytes_written);
+	file_stream->close();
+}
+
+void BinaryLogWriter::_write_session(std::string & output, const std::shared_ptr<Session> & session)
+{
+	std::vector<std::vector<const Event *>> blocks(1);
+
+	for (auto & event : session->events)
+	{
+		if (!_is_written_event(event.type))
+			continue;
+
+		if (blocks.back().size() >= BinaryLogWriter::BLOCK_SIZE)
+			blocks.push_back(std::vector<const Event *>());
+
+		blocks.back().push_back(&event);
+	}
+
+	if (blocks.back().empty())
+		blocks.pop_back();
+
+	const gint64 start = session->start->to_unix();
+	const gint64 stop = session->stop->to_unix();
+
+	_put_string(output, session->target.raw());
+	_put_int64(output, start);
+	_put_int64(output, stop);
+	_put_varint(output, blocks.size());
+
+	for (auto & block : blocks)
+		this->_write_block(output, block);
+}
+
+void BinaryLogWriter::_write_block(std::string & output, const std::vector<const Event *> & events)
+{
+	gint64 first_timestamp = events.front()->timestamp;
+	gint64 last_timestamp = first_timestamp;
+
+	for (auto event : events)
+	{
+		first_timestamp = std::min(first_timestamp, event->timestamp);
+		last_timestamp = std::max(last_timestamp, event->timestamp);
+	}
+
+	std::vector<guint32> strings;
+	std::unordered_map<guint32, guint64> string_ids;
+
+	auto intern = [&](guint32 pool_id) -> guint64
+	{
+		auto result = string_ids.insert(std::make_pair(pool_id, strings.size()));
+
+		if (result.second)
+			strings.push_back(pool_id);
+
+		return result.first->second;
+	};
+
+	std::string types;
+	std::string timestamps;
+	std::string users;
+	std::string message_lengths;
+	std::string messages;
+
+	gint64 previous_timestamp = first_timestamp;
+
+	for (auto event : events)
+	{
+		const gint64 delta = event->timestamp - previous_timestamp;
+		previous_timestamp = event->timestamp;
+
+		types.push_back(static_cast<char>(event->type));
+		_put_varint(timestamps, (static_cast<guint64>(delta) << 1) ^ static_cast<guint64>(delta >> 63));
+
+		const User & subject = event->get_subject();
+		const User & object = event->get_object();
+
+		_put_varint(users, intern(subject.nick));
+		_put_varint(users, intern(subject.user));
+		_put_varint(users, intern(subject.host));
+		_put_varint(users, intern(object.nick));
+		_put_varint(users, intern(object.user));
+		_put_varint(users, intern(object.host));
+
+		_put_varint(message_lengths, event->message_length);
+		messages.append(event->message, event->message_length);
+	}
+
+	std::string body;
+	_put_varint(body, strings.size());
+
+	for (guint32 pool_id : strings)
+		_put_string(body, StringPool::get(pool_id));
+
+	body.append(types);
+	body.append(timestamps);
+	body.append(users);
+	body.append(message_lengths);
+	body.append(messages);
+
+	_put_varint(output, events.size());
+	_put_int64(output, first_timestamp);
+	_put_int64(output, last_timestamp);
+	_put_varint(output, body.size());
+	output.append(body);
 }
@@ -24,6 +24,8 @@
 #define CHATSTATS_LOG_WRITER_HH
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <giomm/file.h>
 #include <glibmm/ustring.h>
@@ -31,28 +33,55 @@
 #include "session.hh"
 
 class LogWriter
+{
+	public:
+		virtual ~LogWriter() { };
+
+		virtual Glib::ustring get_extension() const = 0;
+		virtual void write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions) = 0;
+};
+
+class ChatstatsLogWriter : public LogWriter
 {
 	public:
 		const static Glib::ustring TIMESTAMP_FORMAT;
 
-		void write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions);
+		virtual Glib::ustring get_extension() const;
+		virtual void write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions);
 
 	protected:
+		Glib::ustring _format_timestamp(gint64 timestamp);
+
 		Glib::ustring _format_session_start(std::shared_ptr<const Glib::DateTime> timestamp);
 		Glib::ustring _format_session_stop(std::shared_ptr<const Glib::DateTime> timestamp);
 		Glib::ustring _format_session_target(const Glib::ustring & target);
 
-		Glib::ustring _format_action(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_ctcp(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_join(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_kick(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_message(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_mode_change(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_nick_change(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_notice(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_part(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_quit(const std::shared_ptr<const Event> & event);
-		Glib::ustring _format_topic_change(const std::shared_ptr<const Event> & event);
+		Glib::ustring _format_action(const Event & event);
+		Glib::ustring _format_ctcp(const Event & event);
+		Glib::ustring _format_join(const Event & event);
+		Glib::ustring _format_kick(const Event & event);
+		Glib::ustring _format_message(const Event & event);
+		Glib::ustring _format_mode_change(const Event & event);
+		Glib::ustring _format_nick_change(const Event & event);
+		Glib::ustring _format_notice(const Event & event);
+		Glib::ustring _format_part(const Event & event);
+		Glib::ustring _format_quit(const Event & event);
+		Glib::ustring _format_topic_change(const Event & event);
+};
+
+class BinaryLogWriter : public LogWriter
+{
+	public:
+		const static std::string MAGIC;
+		const static guint32 VERSION;
+		const static size_t BLOCK_SIZE;
+
+		virtual Glib::ustring get_extension() const;
+		virtual void write(Glib::RefPtr<Gio::File> file, std::vector<std::shared_ptr<Session>> sessions);
+
+	private:
+		void _write_session(std::string & output, const std::shared_ptr<Session> & session);
+		void _write_block(std::string & output, const std::vector<const Event *> & events);
 };
 
 #endif // CHATSTATS_LOG_WRITER_HH
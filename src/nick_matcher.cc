@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+
+#include "nick_matcher.hh"
+
+NickMatcher::NickMatcher() :
+	_count(0),
+	_nodes(1)
+{ }
+
+void NickMatcher::add(const Glib::ustring & pattern)
+{
+	const std::string & value = pattern.raw();
+	const size_t index = this->_count++;
+	const size_t wildcard = value.find_first_of("*?");
+
+	if (wildcard == std::string::npos)
+	{
+		this->_literals[value].push_back(index);
+		return;
+	}
+
+	guint32 node = 0;
+
+	for (size_t i = 0; i < wildcard; i++)
+	{
+		const guint64 edge = (static_cast<guint64>(node) << 8) | static_cast<guchar>(value[i]);
+		auto iter = this->_edges.find(edge);
+
+		if (iter == this->_edges.end())
+		{
+			iter = this->_edges.insert(std::make_pair(edge, static_cast<guint32>(this->_nodes.size()))).first;
+			this->_nodes.push_back(std::vector<Pattern>());
+		}
+
+		node = iter->second;
+	}
+
+	this->_nodes[node].push_back(Pattern{index, value.substr(wildcard)});
+}
+
+int NickMatcher::match(const std::string & text) const
+{
+	std::vector<size_t> indexes;
+	this->_match(text, indexes, true);
+
+	return indexes.empty() ? -1 : indexes.front();
+}
+
+std::vector<size_t> NickMatcher::match_all(const std::string & text) const
+{
+	std::vector<size_t> indexes;
+	this->_match(text, indexes, false);
+
+	std::sort(indexes.begin(), indexes.end());
+
+	return indexes;
+}
+
+void NickMatcher::_match(const std::string & text, std::vector<size_t> & indexes, bool first_only) const
+{
+	auto literal_iter = this->_literals.find(text);
+
+	if (literal_iter != this->_literals.end())
+		indexes.insert(indexes.end(), literal_iter->second.begin(), first_only ? literal_iter->second.begin() + 1 : literal_iter->second.end());
+
+	guint32 node = 0;
+
+	for (size_t depth = 0; depth <= text.length(); depth++)
+	{
+		for (const Pattern & pattern : this->_nodes[node])
+		{
+			if (first_only && !indexes.empty() && pattern.index > indexes.front())
+				break;
+
+			if (pattern.remainder == "*" || NickMatcher::_match_remainder(pattern.remainder, text.data() + depth, text.length() - depth))
+			{
+				if (first_only)
+				{
+					indexes.assign(1, pattern.index);
+					break;
+				}
+
+				indexes.push_back(pattern.index);
+			}
+		}
+
+		if (depth == text.length())
+			break;
+
+		auto iter = this->_edges.find((static_cast<guint64>(node) << 8) | static_cast<guchar>(text[depth]));
+
+		if (iter == this->_edges.end())
+			break;
+
+		node = iter->second;
+	}
+}
+
+bool NickMatcher::_match_remainder(const std::string & remainder, const char * text, size_t length)
+{
+	std::vector<char> reachable(length + 1, false);
+	std::vector<char> next(length + 1);
+
+	reachable[0] = true;
+
+	for (const char token : remainder)
+	{
+		std::fill(next.begin(), next.end(), false);
+
+		for (size_t i = 0; i <= length; i++)
+		{
+			if (!reachable[i] && !(token == '*' && next[i]))
+				continue;
+
+			const size_t step = i < length ? g_utf8_skip[static_cast<guchar>(text[i])] : 0;
+
+			if (token == '*' || token == '?')
+			{
+				next[i] = true;
+
+				if (step > 0 && i + step <= length)
+					next[i + step] = true;
+			}
+			else if (i < length && text[i] == token)
+			{
+				next[i + 1] = true;
+			}
+		}
+
+		reachable.swap(next);
+	}
+
+	return reachable[length];
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHATSTATS_NICK_MATCHER_HH
+#define CHATSTATS_NICK_MATCHER_HH
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/ustring.h>
+
+class NickMatcher
+{
+	public:
+		NickMatcher();
+
+		void add(const Glib::ustring & pattern);
+
+		int match(const std::string & text) const;
+		std::vector<size_t> match_all(const std::string & text) const;
+
+	private:
+		class Pattern
+		{
+			public:
+				size_t index;
+				std::string remainder;
+		};
+
+		void _match(const std::string & text, std::vector<size_t> & indexes, bool first_only) const;
+
+		static bool _match_remainder(const std::string & remainder, const char * text, size_t length);
+
+		size_t _count;
+
+		std::unordered_map<std::string, std::vector<size_t>> _literals;
+
+		std::unordered_map<guint64, guint32> _edges;
+		std::vector<std::vector<Pattern>> _nodes;
+};
+
+#endif // CHATSTATS_NICK_MATCHER_HH
@@ -20,20 +20,46 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #include <glibmm/datetime.h>
 #include <glibmm/miscutils.h>
 
-#include "log_writer.hh"
 #include "operation.hh"
 
+class ParsedFile
+{
+	public:
+		ParsedFile() :
+			done(false)
+		{ }
+
+		std::shared_ptr<const LogContents> contents;
+		std::vector<std::shared_ptr<Session>> sessions;
+		WarningList warnings;
+		std::exception_ptr error;
+
+		bool done;
+};
+
+const size_t Operation::STREAMING_BATCH_SIZE = 100000;
+
 Operation::Operation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader) :
 	_input_directory(input_directory),
-	_reader(reader)
-{ }
+	_reader(reader),
+	_jobs(1),
+	_warning_mode(WarningMode::SUMMARY)
+{
+	this->_warning_counts.fill(0);
+	this->_warning_files.fill(0);
+}
 
 Operation::~Operation()
 { }
@@ -42,22 +68,245 @@ void Operation::execute()
 {
 	this->_start_time = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc());
 
-	for (const std::string & filename : this->_get_input_filenames())
+	const std::set<std::string> filenames = this->_get_input_filenames();
+
+	if (this->_jobs > 1 && filenames.size() > 1)
+	{
+		this->_read_files_parallel(std::vector<std::string>(filenames.begin(), filenames.end()));
+	}
+	else
+	{
+		for (const std::string & filename : filenames)
+		{
+			if (this->_jobs > 1 || this->_parse_cache)
+			{
+				WarningList warnings;
+				auto contents = std::make_shared<const LogContents>(Gio::File::create_for_path(filename));
+				auto sessions = this->_read_file(this->_reader, filename, contents, this->_jobs, warnings);
+
+				this->_report_warnings(filename, warnings);
+				this->_begin_file(filename, *contents);
+				this->_handle_sessions(sessions);
+			}
+			else
+			{
+				this->_read_file_streaming(filename);
+			}
+		}
+	}
+
+	this->_report_warning_summary();
+	this->_cleanup();
+}
+
+void Operation::set_jobs(unsigned int jobs)
+{
+	this->_jobs = jobs;
+}
+
+void Operation::set_parse_cache(std::shared_ptr<const ParseCache> parse_cache)
+{
+	this->_parse_cache = parse_cache;
+}
+
+void Operation::set_warning_mode(WarningMode warning_mode)
+{
+	this->_warning_mode = warning_mode;
+}
+
+std::vector<std::shared_ptr<Session>> Operation::_read_file(const std::shared_ptr<LogReader> & reader, const std::string & filename, const std::shared_ptr<const LogContents> & contents, unsigned int jobs, WarningList & warnings) const
+{
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	if (this->_parse_cache && this->_parse_cache->load(filename, *contents, sessions, warnings))
+		return sessions;
+
+	sessions = reader->read(contents, jobs);
+	warnings = reader->get_warnings();
+
+	if (this->_parse_cache)
+		this->_parse_cache->store(filename, *contents, sessions, warnings);
+
+	return sessions;
+}
+
+void Operation::_read_file_streaming(const std::string & filename)
+{
+	std::vector<std::shared_ptr<Session>> sessions;
+	size_t event_count = 0;
+
+	auto contents = std::make_shared<const LogContents>(Gio::File::create_for_path(filename));
+
+	this->_begin_file(filename, *contents);
+	this->_reader->open(contents);
+
+	while (auto session = this->_reader->read_session())
+	{
+		sessions.push_back(session);
+		event_count += session->events.size();
+
+		if (event_count >= Operation::STREAMING_BATCH_SIZE)
+		{
+			this->_handle_sessions(sessions);
+
+			sessions.clear();
+			event_count = 0;
+		}
+	}
+
+	this->_reader->close();
+
+	this->_report_warnings(filename, this->_reader->get_warnings());
+	this->_handle_sessions(sessions);
+}
+
+void Operation::_read_files_parallel(const std::vector<std::string> & filenames)
+{
+	std::vector<ParsedFile> files(filenames.size());
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	const size_t window = this->_jobs * 2;
+	size_t next = 0;
+	size_t consumed = 0;
+	bool stopped = false;
+
+	auto worker = [&](std::shared_ptr<LogReader> reader)
+	{
+		while (true)
+		{
+			size_t index;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&]() { return stopped || next >= filenames.size() || next < consumed + window; });
+
+				if (stopped || next >= filenames.size())
+					return;
+
+				index = next++;
+			}
+
+			ParsedFile file;
+
+			try
+			{
+				file.contents = std::make_shared<const LogContents>(Gio::File::create_for_path(filenames[index]));
+				file.sessions = this->_read_file(reader, filenames[index], file.contents, 1, file.warnings);
+			}
+			catch (...)
+			{
+				file.error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				files[index] = std::move(file);
+				files[index].done = true;
+			}
+
+			condition.notify_all();
+		}
+	};
+
+	for (unsigned int i = 0; i < this->_jobs; i++)
+		workers.push_back(std::thread(worker, this->_reader->clone()));
+
+	try
 	{
-		auto sessions = this->_reader->read(Gio::File::create_for_path(filename));
+		for (size_t index = 0; index < filenames.size(); index++)
+		{
+			ParsedFile file;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&]() { return files[index].done; });
+
+				file = std::move(files[index]);
+				files[index] = ParsedFile();
+				consumed = index + 1;
+			}
+
+			condition.notify_all();
 
-		for (auto warning : this->_reader->get_warnings())
+			if (file.error)
+				std::rethrow_exception(file.error);
+
+			this->_report_warnings(filenames[index], file.warnings);
+			this->_begin_file(filenames[index], *file.contents);
+			this->_handle_sessions(file.sessions);
+		}
+	}
+	catch (...)
+	{
 		{
-			auto filename_string = Glib::ustring::format(std::setw(30), Glib::ustring::compose("%1:%2", Glib::path_get_basename(filename), warning.first));
-			std::cerr << Glib::ustring::compose("%1: %2", filename_string, warning.second) << std::endl;
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
 		}
 
-		this->_handle_sessions(sessions);
+		condition.notify_all();
+
+		for (auto & thread : workers)
+			thread.join();
+
+		throw;
 	}
 
-	this->_cleanup();
+	for (auto & thread : workers)
+		thread.join();
 }
 
+void Operation::_report_warnings(const std::string & filename, const WarningList & warnings)
+{
+	for (size_t i = 0; i < this->_warning_counts.size(); i++)
+	{
+		const guint64 count = warnings.get_count(static_cast<WarningType>(i));
+
+		this->_warning_counts[i] += count;
+		this->_warning_files[i] += count > 0 ? 1 : 0;
+	}
+
+	if (this->_warning_mode != WarningMode::FULL)
+		return;
+
+	for (const Warning & warning : warnings.get_samples())
+	{
+		auto filename_string = Glib::ustring::format(std::setw(30), Glib::ustring::compose("%1:%2", Glib::path_get_basename(filename), warning.line));
+		std::cerr << Glib::ustring::compose("%1: %2", filename_string, warning.to_string()) << std::endl;
+	}
+
+	for (size_t i = 0; i < this->_warning_counts.size(); i++)
+	{
+		const guint64 count = warnings.get_count(static_cast<WarningType>(i));
+
+		if (count > WarningList::SAMPLE_LIMIT)
+		{
+			auto filename_string = Glib::ustring::format(std::setw(30), Glib::path_get_basename(filename));
+			std::cerr << Glib::ustring::compose("%1: %2 more warnings not shown: %3", filename_string, count - WarningList::SAMPLE_LIMIT, WarningList::get_description(static_cast<WarningType>(i))) << std::endl;
+		}
+	}
+}
+
+void Operation::_report_warning_summary() const
+{
+	if (this->_warning_mode == WarningMode::NONE || std::all_of(this->_warning_counts.begin(), this->_warning_counts.end(), [](guint64 count) { return count == 0; }))
+		return;
+
+	std::cerr << Glib::ustring::compose("%1 %2 %3", Glib::ustring::format(std::left, std::setw(50), "Warning"), Glib::ustring::format(std::setw(12), "Lines"), Glib::ustring::format(std::setw(8), "Files")) << std::endl;
+
+	for (size_t i = 0; i < this->_warning_counts.size(); i++)
+	{
+		if (this->_warning_counts[i] > 0)
+			std::cerr << Glib::ustring::compose("%1 %2 %3", Glib::ustring::format(std::left, std::setw(50), WarningList::get_description(static_cast<WarningType>(i))), Glib::ustring::format(std::setw(12), this->_warning_counts[i]), Glib::ustring::format(std::setw(8), this->_warning_files[i])) << std::endl;
+	}
+}
+
+void Operation::_begin_file(const std::string &, const LogContents &)
+{ }
+
 std::set<std::string> Operation::_get_input_filenames()
 {
 	std::set<std::string> filenames;
@@ -72,9 +321,10 @@ std::set<std::string> Operation::_get_input_filenames()
 	return filenames;
 }
 
-ConvertOperation::ConvertOperation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader, Glib::RefPtr<Gio::File> output_directory) :
+ConvertOperation::ConvertOperation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader, Glib::RefPtr<Gio::File> output_directory, std::shared_ptr<LogWriter> writer) :
 	Operation(input_directory, reader),
-	_output_directory(output_directory)
+	_output_directory(output_directory),
+	_writer(writer)
 { }
 
 void ConvertOperation::_cleanup()
@@ -114,41 +364,44 @@ void ConvertOperation::_handle_sessions(const std::vector<std::shared_ptr<Sessio
 
 void ConvertOperation::_write_sessions()
 {
-	LogWriter log_writer;
-
 	if (!this->_sessions.empty())
 	{
 		std::shared_ptr<Session> first_session = this->_sessions.front();
 
-		Glib::ustring output_filename(Glib::ustring::compose("%1-%2.log", first_session->target, first_session->start->format("%Y%m")));
+		Glib::ustring output_filename(Glib::ustring::compose("%1-%2.%3", first_session->target, first_session->start->format("%Y%m"), this->_writer->get_extension()));
 		Glib::RefPtr<Gio::File> output_file = Gio::File::create_for_path(Glib::build_filename(this->_output_directory->get_path(), output_filename));
 
-		log_writer.write(output_file, this->_sessions);
+		this->_writer->write(output_file, this->_sessions);
 
 		this->_sessions.clear();
 	}
 }
 
 CountOperation::CountOperation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader) :
-	Operation(input_directory, reader)
+	Operation(input_directory, reader),
+	_current_day(G_MININT64),
+	_count(0)
 { }
 
 void CountOperation::_handle_sessions(const std::vector<std::shared_ptr<Session>> & sessions)
 {
 	for (auto session : sessions)
 	{
-		for (auto event : session->events)
+		for (auto & event : session->events)
 		{
-			if (event->type == EventType::MESSAGE || event->type == EventType::ACTION)
+			if (event.type == EventType::MESSAGE || event.type == EventType::ACTION)
 			{
-				Glib::ustring date = event->timestamp->format("%Y-%m-%d");
+				const gint64 day = event.timestamp >= 0 ? event.timestamp / 86400 : (event.timestamp - 86399) / 86400;
 
-				if (date != this->_current_date)
+				if (day != this->_current_day)
 				{
+					Glib::ustring date = Glib::DateTime::create_now_utc(day * 86400).format("%Y-%m-%d");
+
 					if (this->_current_date != "")
 						std::cout << this->_current_date << "\t" << this->_count << std::endl;
 
 					this->_current_date = date;
+					this->_current_day = day;
 					this->_count = 0;
 				}
 
@@ -243,27 +496,29 @@ void FrequencyOperation::_handle_sessions(const std::vector<std::shared_ptr<Sess
 		if (!this->_stop || session->stop->to_unix() > this->_stop->to_unix())
 			this->_stop = session->stop;
 
-		for (auto event : session->events)
+		for (auto & event : session->events)
 		{
-			if (event->type == EventType::MESSAGE || event->type == EventType::ACTION)
+			if (event.type == EventType::MESSAGE || event.type == EventType::ACTION)
 			{
-				for (auto token : _tokenize(event->message))
+				for (auto token : _tokenize(event.get_message()))
 				{
 					if (token != "")
 					{
-						if (!this->_last[token])
-							this->_last[token] = this->_start;
+						const guint32 token_id = StringPool::intern(token.raw());
+
+						if (this->_last.count(token_id) == 0)
+							this->_last[token_id] = this->_start->to_unix();
 
-						int gap = event->timestamp->difference(*(this->_last[token])) / 1000000;
+						int gap = event.timestamp - this->_last[token_id];
 
-						if (gap > this->_max[token])
-							this->_max[token] = gap;
+						if (gap > this->_max[token_id])
+							this->_max[token_id] = gap;
 
-						if (this->_min[token] == 0 || gap < this->_min[token])
-							this->_min[token] = gap;
+						if (this->_min[token_id] == 0 || gap < this->_min[token_id])
+							this->_min[token_id] = gap;
 
-						this->_count[token]++;
-						this->_last[token] = event->timestamp;
+						this->_count[token_id]++;
+						this->_last[token_id] = event.timestamp;
 					}
 				}
 			}
@@ -275,22 +530,24 @@ void FrequencyOperation::_cleanup()
 {
 	double total_time = static_cast<double>(this->_stop->difference(*(this->_start))) / 1000000;
 
-	std::set<std::pair<double, Glib::ustring>> scores;
+	std::set<std::pair<double, std::pair<Glib::ustring, guint32>>> scores;
 
 	for (auto pair : this->_count)
 	{
-		Glib::ustring token = pair.first;
+		Glib::ustring token = StringPool::get(pair.first);
 		double average = total_time / pair.second;
 
 		double score = abs(average - this->_target);
 
-		if (this->_max[token] < this->_target * 8.0)
-			scores.insert(std::make_pair(score, token));
+		if (this->_max[pair.first] < this->_target * 8.0)
+			scores.insert(std::make_pair(score, std::make_pair(token, pair.first)));
 	}
 
 	for (auto pair : scores)
 	{
+		const guint32 token_id = pair.second.second;
+
 		std::cout << std::fixed << std::setprecision(5);
-		std::cout << std::setw(30) << pair.second << "\t" << pair.first << "\t" << this->_count[pair.second] << "\t" << (total_time / this->_count[pair.second]) << "\t" << this->_min[pair.second] << "\t" << this->_max[pair.second] << std::endl;
+		std::cout << std::setw(30) << pair.second.first << "\t" << pair.first << "\t" << this->_count[token_id] << "\t" << (total_time / this->_count[token_id]) << "\t" << this->_min[token_id] << "\t" << this->_max[token_id] << std::endl;
 	}
 }
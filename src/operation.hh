@@ -23,6 +23,8 @@
 #ifndef CHATSTATS_OPERATION_HH
 #define CHATSTATS_OPERATION_HH
 
+#include <array>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -33,24 +35,47 @@
 #include <glibmm/ustring.h>
 
 #include "log_reader.hh"
+#include "log_writer.hh"
+#include "parse_cache.hh"
 #include "session.hh"
+#include "warning_list.hh"
 
 class Operation
 {
 	public:
+		const static size_t STREAMING_BATCH_SIZE;
+
 		Operation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader);
 		virtual ~Operation();
 
 		void execute();
 
+		void set_jobs(unsigned int jobs);
+		void set_parse_cache(std::shared_ptr<const ParseCache> parse_cache);
+		void set_warning_mode(WarningMode warning_mode);
+
 	protected:
 		Glib::RefPtr<Gio::File> _input_directory;
 		std::shared_ptr<LogReader> _reader;
 
-		std::set<std::string> _get_input_filenames();
+		unsigned int _jobs;
+		std::shared_ptr<const ParseCache> _parse_cache;
+
+		WarningMode _warning_mode;
+		std::array<guint64, static_cast<size_t>(WarningType::COUNT)> _warning_counts;
+		std::array<guint64, static_cast<size_t>(WarningType::COUNT)> _warning_files;
+
+		virtual std::set<std::string> _get_input_filenames();
+
+		std::vector<std::shared_ptr<Session>> _read_file(const std::shared_ptr<LogReader> & reader, const std::string & filename, const std::shared_ptr<const LogContents> & contents, unsigned int jobs, WarningList & warnings) const;
+		void _read_file_streaming(const std::string & filename);
+		void _read_files_parallel(const std::vector<std::string> & filenames);
+		void _report_warnings(const std::string & filename, const WarningList & warnings);
+		void _report_warning_summary() const;
 
 		std::shared_ptr<const Glib::DateTime> _start_time;
 
+		virtual void _begin_file(const std::string & filename, const LogContents & contents);
 		virtual void _cleanup() = 0;
 		virtual void _handle_sessions(const std::vector<std::shared_ptr<Session>> & sessions) = 0;
 };
@@ -58,7 +83,7 @@ class Operation
 class ConvertOperation : public Operation
 {
 	public:
-		ConvertOperation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader, Glib::RefPtr<Gio::File> output_directory);
+		ConvertOperation(Glib::RefPtr<Gio::File> input_directory, std::shared_ptr<LogReader> reader, Glib::RefPtr<Gio::File> output_directory, std::shared_ptr<LogWriter> writer);
 
 	protected:
 		virtual void _cleanup();
@@ -68,6 +93,7 @@ class ConvertOperation : public Operation
 		void _write_sessions();
 
 		Glib::RefPtr<Gio::File> _output_directory;
+		std::shared_ptr<LogWriter> _writer;
 
 		std::vector<std::shared_ptr<Session>> _sessions;
 };
@@ -83,6 +109,7 @@ class CountOperation : public Operation
 
 	private:
 		Glib::ustring _current_date;
+		gint64 _current_day;
 		int _count;
 };
 
@@ -117,10 +144,10 @@ class FrequencyOperation : public Operation
 	private:
 		double _target;
 
-		std::unordered_map<std::string, std::shared_ptr<const Glib::DateTime>> _last;
-		std::unordered_map<std::string, int> _max;
-		std::unordered_map<std::string, int> _min;
-		std::unordered_map<std::string, int> _count;
+		std::unordered_map<guint32, gint64> _last;
+		std::unordered_map<guint32, int> _max;
+		std::unordered_map<guint32, int> _min;
+		std::unordered_map<guint32, int> _count;
 
 		std::shared_ptr<const Glib::DateTime> _start;
 		std::shared_ptr<const Glib::DateTime> _stop;
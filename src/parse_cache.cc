@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <glibmm/checksum.h>
+
+#include "log_input.hh"
+#include "parse_cache.hh"
+
+class CacheWriter
+{
+	public:
+		void write_uint8(guint8 value)
+		{
+			this->data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		void write_uint32(guint32 value)
+		{
+			this->data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		void write_int64(gint64 value)
+		{
+			this->data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		void write_string(const std::string & value)
+		{
+			this->write_uint32(value.size());
+			this->data.append(value);
+		}
+
+		void write_timestamp(const std::shared_ptr<const Glib::DateTime> & timestamp)
+		{
+			this->write_int64(timestamp ? timestamp->to_unix() : std::numeric_limits<gint64>::min());
+		}
+
+		guint32 intern(const Glib::ustring & value)
+		{
+			auto result = this->string_ids.insert(std::make_pair(value.raw(), this->strings.size()));
+
+			if (result.second)
+				this->strings.push_back(value.raw());
+
+			return result.first->second;
+		}
+
+		guint32 intern(guint32 pool_id)
+		{
+			auto iter = this->pool_ids.find(pool_id);
+
+			if (iter == this->pool_ids.end())
+				iter = this->pool_ids.insert(std::make_pair(pool_id, this->intern(StringPool::get(pool_id)))).first;
+
+			return iter->second;
+		}
+
+		std::string data;
+
+		std::vector<std::string> strings;
+		std::unordered_map<std::string, guint32> string_ids;
+		std::unordered_map<guint32, guint32> pool_ids;
+};
+
+class CacheReader
+{
+	public:
+		CacheReader(const char * data, gsize length) :
+			_begin(data),
+			_position(data),
+			_end(data + length)
+		{ }
+
+		guint8 read_uint8()
+		{
+			guint8 value;
+			this->_read(&value, sizeof(value));
+			return value;
+		}
+
+		guint32 read_uint32()
+		{
+			guint32 value;
+			this->_read(&value, sizeof(value));
+			return value;
+		}
+
+		gint64 read_int64()
+		{
+			gint64 value;
+			this->_read(&value, sizeof(value));
+			return value;
+		}
+
+		const char * read_bytes(guint32 & length)
+		{
+			length = this->read_uint32();
+
+			if (length > static_cast<gsize>(this->_end - this->_position))
+				throw std::runtime_error("Truncated cache entry");
+
+			const char * value = this->_position;
+			this->_position += length;
+
+			return value;
+		}
+
+		std::string read_string()
+		{
+			guint32 length;
+			const char * value = this->read_bytes(length);
+
+			return std::string(value, length);
+		}
+
+		std::shared_ptr<const Glib::DateTime> read_timestamp()
+		{
+			const gint64 unix_time = this->read_int64();
+
+			if (unix_time == std::numeric_limits<gint64>::min())
+				return nullptr;
+
+			if (!this->_timestamp || this->_timestamp->to_unix() != unix_time)
+				this->_timestamp = std::make_shared<const Glib::DateTime>(Glib::DateTime::create_now_utc(unix_time));
+
+			return this->_timestamp;
+		}
+
+		const Glib::ustring & read_interned()
+		{
+			const guint32 id = this->read_uint32();
+
+			if (id >= this->strings.size())
+				throw std::runtime_error("Invalid string in cache entry");
+
+			return this->strings[id];
+		}
+
+		guint32 read_pool_id()
+		{
+			const guint32 id = this->read_uint32();
+
+			if (id >= this->strings.size())
+				throw std::runtime_error("Invalid string in cache entry");
+
+			if (this->pool_ids.size() < this->strings.size())
+				this->pool_ids.resize(this->strings.size(), G_MAXUINT32);
+
+			if (this->pool_ids[id] == G_MAXUINT32)
+				this->pool_ids[id] = StringPool::intern(this->strings[id].raw());
+
+			return this->pool_ids[id];
+		}
+
+		bool at_end() const
+		{
+			return this->_position == this->_end;
+		}
+
+		gsize get_offset() const
+		{
+			return this->_position - this->_begin;
+		}
+
+		std::vector<Glib::ustring> strings;
+		std::vector<guint32> pool_ids;
+
+	private:
+		void _read(void * value, gsize length)
+		{
+			if (length > static_cast<gsize>(this->_end - this->_position))
+				throw std::runtime_error("Truncated cache entry");
+
+			memcpy(value, this->_position, length);
+			this->_position += length;
+		}
+
+		const char * _begin;
+		const char * _position;
+		const char * _end;
+
+		std::shared_ptr<const Glib::DateTime> _timestamp;
+};
+
+const guint32 ParseCache::VERSION = 4;
+
+ParseCache::ParseCache(const Glib::RefPtr<Gio::File> & directory, const Glib::ustring & input_format) :
+	_directory(directory),
+	_input_format(input_format)
+{ }
+
+bool ParseCache::load(const std::string & filename, const LogContents & log_contents, std::vector<std::shared_ptr<Session>> & sessions, WarningList & warnings) const
+{
+	auto entry_file = this->_get_entry_file(filename);
+
+	if (!entry_file->query_exists())
+		return false;
+
+	try
+	{
+		auto contents = std::make_shared<const LogContents>(entry_file);
+		CacheReader reader(contents->get_data(), contents->get_length());
+
+		if (reader.read_string() != "chatstats-cache" || reader.read_uint32() != ParseCache::VERSION)
+			return false;
+
+		if (reader.read_string() != this->_input_format.raw() || reader.read_string() != filename)
+			return false;
+
+		const gint64 size = reader.read_int64();
+		const gsize modification_time_offset = reader.get_offset();
+		const gint64 modification_time = reader.read_int64();
+		const std::string content_hash = reader.read_string();
+
+		if (size != static_cast<gint64>(log_contents.get_length()))
+			return false;
+
+		const bool modified = modification_time != log_contents.get_modification_time();
+
+		if (modified && content_hash != log_contents.get_checksum())
+			return false;
+
+		for (guint32 i = 0, count = reader.read_uint32(); i < count; i++)
+			reader.strings.push_back(reader.read_string());
+
+		WarningList cached_warnings;
+
+		for (guint32 i = 0, count = reader.read_uint32(); i < count; i++)
+		{
+			const int line = static_cast<gint32>(reader.read_uint32());
+			const guint8 type = reader.read_uint8();
+
+			if (type >= static_cast<guint8>(WarningType::COUNT))
+				return false;
+
+			const Glib::ustring & detail = reader.read_interned();
+			cached_warnings.add(line, static_cast<WarningType>(type), detail.data(), detail.data() + detail.bytes());
+		}
+
+		for (guint8 type = 0; type < static_cast<guint8>(WarningType::COUNT); type++)
+		{
+			const gint64 count = reader.read_int64();
+
+			if (count < static_cast<gint64>(cached_warnings.get_count(static_cast<WarningType>(type))))
+				return false;
+
+			cached_warnings.add_unsampled(static_cast<WarningType>(type), count - cached_warnings.get_count(static_cast<WarningType>(type)));
+		}
+
+		const gsize minimum_event_length = sizeof(guint8) + sizeof(gint64) + 7 * sizeof(guint32);
+
+		auto arena = std::make_shared<Arena>(contents);
+		std::vector<std::shared_ptr<Session>> cached_sessions;
+		User::Cache user_cache;
+
+		for (guint32 i = 0, count = reader.read_uint32(); i < count; i++)
+		{
+			auto session = std::make_shared<Session>();
+
+			session->events = EventList(arena);
+			session->target = reader.read_interned();
+			session->start = reader.read_timestamp();
+			session->stop = reader.read_timestamp();
+
+			const guint32 event_count = reader.read_uint32();
+
+			if (event_count > (contents->get_length() - reader.get_offset()) / minimum_event_length)
+				return false;
+
+			session->events.reserve(event_count);
+
+			for (guint32 j = 0; j < event_count; j++)
+			{
+				const guint8 type = reader.read_uint8();
+
+				if (type > static_cast<guint8>(EventType::PARSE_SESSION_TARGET))
+					return false;
+
+				const gint64 timestamp = reader.read_int64();
+
+				const guint32 subject_nick = reader.read_pool_id();
+				const guint32 subject_user = reader.read_pool_id();
+				const guint32 subject_host = reader.read_pool_id();
+				const guint32 object_nick = reader.read_pool_id();
+				const guint32 object_user = reader.read_pool_id();
+				const guint32 object_host = reader.read_pool_id();
+
+				const guint32 subject = User::intern(user_cache, User(subject_nick, subject_user, subject_host));
+				const guint32 object = User::intern(user_cache, User(object_nick, object_user, object_host));
+
+				guint32 message_length;
+				const char * message = reader.read_bytes(message_length);
+
+				session->events.push_back(Event(static_cast<EventType>(type), timestamp, subject, object, message, message_length));
+			}
+
+			cached_sessions.push_back(session);
+		}
+
+		if (!reader.at_end())
+			return false;
+
+		if (modified)
+			this->_update_modification_time(entry_file, modification_time_offset, log_contents.get_modification_time());
+
+		sessions.swap(cached_sessions);
+		warnings = cached_warnings;
+
+		return true;
+	}
+	catch (const std::runtime_error &)
+	{
+		return false;
+	}
+	catch (const Glib::Error &)
+	{
+		return false;
+	}
+}
+
+void ParseCache::store(const std::string & filename, const LogContents & log_contents, const std::vector<std::shared_ptr<Session>> & sessions, const WarningList & warnings) const
+{
+	CacheWriter body;
+
+	body.write_uint32(warnings.get_samples().size());
+
+	for (const Warning & warning : warnings.get_samples())
+	{
+		body.write_uint32(static_cast<guint32>(warning.line));
+		body.write_uint8(static_cast<guint8>(warning.type));
+		body.write_uint32(body.intern(warning.detail));
+	}
+
+	for (guint8 type = 0; type < static_cast<guint8>(WarningType::COUNT); type++)
+		body.write_int64(warnings.get_count(static_cast<WarningType>(type)));
+
+	body.write_uint32(sessions.size());
+
+	for (auto session : sessions)
+	{
+		body.write_uint32(body.intern(session->target));
+		body.write_timestamp(session->start);
+		body.write_timestamp(session->stop);
+		body.write_uint32(session->events.size());
+
+		for (auto & event : session->events)
+		{
+			const User & subject = event.get_subject();
+			const User & object = event.get_object();
+
+			body.write_uint8(static_cast<guint8>(event.type));
+			body.write_int64(event.timestamp);
+
+			body.write_uint32(body.intern(subject.nick));
+			body.write_uint32(body.intern(subject.user));
+			body.write_uint32(body.intern(subject.host));
+			body.write_uint32(body.intern(object.nick));
+			body.write_uint32(body.intern(object.user));
+			body.write_uint32(body.intern(object.host));
+
+			body.write_uint32(event.message_length);
+			body.data.append(event.message, event.message_length);
+		}
+	}
+
+	try
+	{
+		CacheWriter header;
+
+		header.write_string("chatstats-cache");
+		header.write_uint32(ParseCache::VERSION);
+		header.write_string(this->_input_format.raw());
+		header.write_string(filename);
+		header.write_int64(log_contents.get_length());
+		header.write_int64(log_contents.get_modification_time());
+		header.write_string(log_contents.get_checksum());
+
+		header.write_uint32(body.strings.size());
+
+		for (const std::string & value : body.strings)
+			header.write_string(value);
+
+		gsize bytes_written;
+
+		auto output_stream = this->_get_entry_file(filename)->replace();
+		output_stream->write_all(header.data, bytes_written);
+		output_stream->write_all(body.data, bytes_written);
+		output_stream->close();
+	}
+	catch (const Glib::Error & error)
+	{
+		std::cerr << Glib::ustring::compose("Unable to cache %1: %2", filename, error.what()) << std::endl;
+	}
+}
+
+bool ParseCache::load_users_file(const std::string & checksum, std::vector<std::shared_ptr<UserSpecification>> & users) const
+{
+	auto entry_file = this->_directory->get_child(Glib::ustring::compose("users-%1.cache", checksum));
+
+	if (!entry_file->query_exists())
+		return false;
+
+	try
+	{
+		LogContents contents(entry_file);
+		CacheReader reader(contents.get_data(), contents.get_length());
+
+		if (reader.read_string() != "chatstats-users-cache" || reader.read_uint32() != ParseCache::VERSION || reader.read_string() != checksum)
+			return false;
+
+		std::vector<std::shared_ptr<UserSpecification>> cached_users;
+
+		for (guint32 i = 0, count = reader.read_uint32(); i < count; i++)
+		{
+			auto user = std::make_shared<UserSpecification>(reader.read_string());
+
+			for (guint32 j = 0, nick_count = reader.read_uint32(); j < nick_count; j++)
+			{
+				const std::string specification = reader.read_string();
+				const std::string nickuserhost_specification = reader.read_string();
+
+				std::shared_ptr<const TimeRange> time_range;
+
+				if (reader.read_uint8())
+				{
+					const std::string start_date = reader.read_string();
+					const std::string end_date = reader.read_string();
+					const std::string start_time = reader.read_string();
+					const std::string end_time = reader.read_string();
+
+					time_range = std::make_shared<const TimeRange>(start_date, end_date, start_time, end_time);
+				}
+
+				user->nick_specifications.push_back(std::make_shared<const NickSpecification>(specification, nickuserhost_specification, time_range));
+			}
+
+			cached_users.push_back(user);
+		}
+
+		if (!reader.at_end())
+			return false;
+
+		users.swap(cached_users);
+
+		return true;
+	}
+	catch (const std::runtime_error &)
+	{
+		return false;
+	}
+	catch (const Glib::Error &)
+	{
+		return false;
+	}
+}
+
+void ParseCache::store_users_file(const std::string & checksum, const std::vector<std::shared_ptr<UserSpecification>> & users) const
+{
+	CacheWriter writer;
+
+	writer.write_string("chatstats-users-cache");
+	writer.write_uint32(ParseCache::VERSION);
+	writer.write_string(checksum);
+	writer.write_uint32(users.size());
+
+	for (auto & user : users)
+	{
+		writer.write_string(user->alias);
+		writer.write_uint32(user->nick_specifications.size());
+
+		for (auto & nick_specification : user->nick_specifications)
+		{
+			writer.write_string(nick_specification->specification);
+			writer.write_string(nick_specification->nickuserhost_specification);
+			writer.write_uint8(nick_specification->time_range ? 1 : 0);
+
+			if (nick_specification->time_range)
+			{
+				writer.write_string(nick_specification->time_range->start_date);
+				writer.write_string(nick_specification->time_range->end_date);
+				writer.write_string(nick_specification->time_range->start_time);
+				writer.write_string(nick_specification->time_range->end_time);
+			}
+		}
+	}
+
+	try
+	{
+		gsize bytes_written;
+
+		auto output_stream = this->_directory->get_child(Glib::ustring::compose("users-%1.cache", checksum))->replace();
+		output_stream->write_all(writer.data, bytes_written);
+		output_stream->close();
+	}
+	catch (const Glib::Error & error)
+	{
+		std::cerr << Glib::ustring::compose("Unable to cache users file: %1", error.what()) << std::endl;
+	}
+}
+
+Glib::RefPtr<Gio::File> ParseCache::_get_entry_file(const std::string & filename) const
+{
+	const std::string key = this->_input_format.raw() + '\0' + filename;
+	return this->_directory->get_child(Glib::Checksum::compute_checksum(Glib::Checksum::CHECKSUM_SHA1, key) + ".cache");
+}
+
+void ParseCache::_update_modification_time(const Glib::RefPtr<Gio::File> & entry_file, gsize offset, gint64 modification_time) const
+{
+	try
+	{
+		gsize bytes_written;
+
+		auto stream = entry_file->open_readwrite();
+		stream->seek(offset, Glib::SEEK_TYPE_SET);
+		stream->get_output_stream()->write_all(&modification_time, sizeof(modification_time), bytes_written);
+		stream->close();
+	}
+	catch (const Glib::Error & error)
+	{
+		std::cerr << Glib::ustring::compose("Unable to update cache entry for %1: %2", entry_file->get_path(), error.what()) << std::endl;
+	}
+}
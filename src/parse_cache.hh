@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_PARSE_CACHE_HH
+#define CHATSTATS_PARSE_CACHE_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <giomm/file.h>
+#include <glibmm/ustring.h>
+
+#include "log_input.hh"
+#include "session.hh"
+#include "user_specification.hh"
+#include "warning_list.hh"
+
+class ParseCache
+{
+	public:
+		const static guint32 VERSION;
+
+		ParseCache(const Glib::RefPtr<Gio::File> & directory, const Glib::ustring & input_format);
+
+		bool load(const std::string & filename, const LogContents & log_contents, std::vector<std::shared_ptr<Session>> & sessions, WarningList & warnings) const;
+		void store(const std::string & filename, const LogContents & log_contents, const std::vector<std::shared_ptr<Session>> & sessions, const WarningList & warnings) const;
+
+		bool load_users_file(const std::string & checksum, std::vector<std::shared_ptr<UserSpecification>> & users) const;
+		void store_users_file(const std::string & checksum, const std::vector<std::shared_ptr<UserSpecification>> & users) const;
+
+	private:
+		Glib::RefPtr<Gio::File> _get_entry_file(const std::string & filename) const;
+		void _update_modification_time(const Glib::RefPtr<Gio::File> & entry_file, gsize offset, gint64 modification_time) const;
+
+		Glib::RefPtr<Gio::File> _directory;
+		Glib::ustring _input_format;
+};
+
+#endif // CHATSTATS_PARSE_CACHE_HH
@@ -20,28 +20,21 @@
  * SOFTWARE.
  */
 
-#include <algorithm>
-
 #include "session.hh"
 
-#include <iostream>
-
 std::shared_ptr<Session> Session::split(const Glib::DateTime & timestamp)
 {
 	if (timestamp.to_unix() < this->start->to_unix() || timestamp.to_unix() > this->stop->to_unix())
 		return nullptr;
 
-	auto session = std::make_shared<Session>();
-
-	auto iter = this->events.begin();
-	while (iter != this->events.end() && (*iter)->timestamp->to_unix() < timestamp.to_unix())
-		iter++;
+	const Event * position = this->events.find(timestamp.to_unix());
 
-	std::move(iter, this->events.end(), session->events.begin());
-
-	if (session->events.empty())
+	if (position == this->events.end())
 		return nullptr;
 
+	auto session = std::make_shared<Session>();
+	session->events = this->events.split(position);
+
 	session->start = std::make_shared<Glib::DateTime>(timestamp);
 	session->stop = this->stop;
 	session->target = this->target;
@@ -23,12 +23,11 @@
 #ifndef CHATSTATS_SESSION_HH
 #define CHATSTATS_SESSION_HH
 
-#include <list>
 #include <memory>
 
 #include <glibmm/datetime.h>
 
-#include "event.hh"
+#include "event_list.hh"
 
 class Session
 {
@@ -40,7 +39,7 @@ class Session
 		std::shared_ptr<const Glib::DateTime> start;
 		std::shared_ptr<const Glib::DateTime> stop;
 
-		std::list<std::shared_ptr<const Event>> events;
+		EventList events;
 };
 
 #endif // CHATSTATS_SESSION_HH
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+
+#include "string_pool.hh"
+
+class StringTable : public InternTable<std::string, StringHash, StringEqual>
+{
+	public:
+		StringTable()
+		{
+			this->intern(std::string());
+		}
+};
+
+static InternTable<std::string, StringHash, StringEqual> & _get_strings()
+{
+	static StringTable strings;
+	return strings;
+}
+
+static size_t _hash_bytes(const char * data, gsize length)
+{
+	guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+
+	for (gsize i = 0; i < length; i++)
+	{
+		hash ^= static_cast<guchar>(data[i]);
+		hash *= G_GUINT64_CONSTANT(1099511628211);
+	}
+
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+size_t StringHash::operator()(const std::string & value) const
+{
+	return _hash_bytes(value.data(), value.size());
+}
+
+size_t StringHash::operator()(const StringKey & key) const
+{
+	return _hash_bytes(key.data, key.length);
+}
+
+bool StringEqual::operator()(const std::string & value, const std::string & other) const
+{
+	return value == other;
+}
+
+bool StringEqual::operator()(const std::string & value, const StringKey & key) const
+{
+	return value.size() == key.length && memcmp(value.data(), key.data, key.length) == 0;
+}
+
+const guint32 StringPool::EMPTY = 0;
+
+guint32 StringPool::intern(const char * data, gsize length)
+{
+	return _get_strings().intern(StringKey(data, length));
+}
+
+guint32 StringPool::intern(const std::string & value)
+{
+	return _get_strings().intern(StringKey(value.data(), value.size()));
+}
+
+guint32 StringPool::intern(Cache & cache, const char * data, gsize length)
+{
+	return cache.intern(_get_strings(), StringKey(data, length));
+}
+
+const std::string & StringPool::get(guint32 id)
+{
+	return _get_strings().get(id);
+}
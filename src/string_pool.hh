@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CHATSTATS_STRING_POOL_HH
+#define CHATSTATS_STRING_POOL_HH
+
+#include <string>
+
+#include <glib.h>
+
+#include "intern_table.hh"
+
+class StringKey
+{
+	public:
+		StringKey(const char * data, gsize length) :
+			data(data),
+			length(length)
+		{ }
+
+		operator std::string() const
+		{
+			return std::string(this->data, this->length);
+		}
+
+		const char * const data;
+		const gsize length;
+};
+
+class StringHash
+{
+	public:
+		size_t operator()(const std::string & value) const;
+		size_t operator()(const StringKey & key) const;
+};
+
+class StringEqual
+{
+	public:
+		bool operator()(const std::string & value, const std::string & other) const;
+		bool operator()(const std::string & value, const StringKey & key) const;
+};
+
+class StringPool
+{
+	public:
+		typedef InternTable<std::string, StringHash, StringEqual>::Cache Cache;
+
+		const static guint32 EMPTY;
+
+		static guint32 intern(const char * data, gsize length);
+		static guint32 intern(const std::string & value);
+		static guint32 intern(Cache & cache, const char * data, gsize length);
+
+		static const std::string & get(guint32 id);
+};
+
+#endif // CHATSTATS_STRING_POOL_HH
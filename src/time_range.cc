@@ -20,36 +20,64 @@
  * SOFTWARE.
  */
 
-#include <glibmm/regex.h>
+#include <cstdlib>
 
 #include "time_range.hh"
+#include "util.hh"
 
 TimeRange::TimeRange(const Glib::ustring & start_date, const Glib::ustring & end_date, const Glib::ustring & start_time, const Glib::ustring & end_time) :
 	start_date(start_date),
 	end_date(end_date),
 	start_time(start_time),
-	end_time(end_time)
+	end_time(end_time),
+	_start_timestamp(start_date.empty() ? G_MININT64 : TimeRange::_parse_date(start_date)),
+	_end_timestamp(end_date.empty() ? G_MAXINT64 : TimeRange::_parse_date(end_date)),
+	_start_time_of_day(start_time.empty() ? 0 : TimeRange::_parse_time(start_time)),
+	_end_time_of_day(end_time.empty() ? 86400 : TimeRange::_parse_time(end_time))
 { }
 
+bool TimeRange::contains(gint64 timestamp) const
+{
+	const gint64 time_of_day = ((timestamp % 86400) + 86400) % 86400;
+
+	return timestamp >= this->_start_timestamp && timestamp < this->_end_timestamp && time_of_day >= this->_start_time_of_day && time_of_day < this->_end_time_of_day;
+}
+
 Glib::ustring TimeRange::get_sql_expression() const
 {
 	Glib::ustring expression;
 
-	this->_append_sql_expression(expression, "DATE(timestamp) >= '%1'", this->start_date);
-	this->_append_sql_expression(expression, "DATE(timestamp) < '%1'", this->end_date);
-	this->_append_sql_expression(expression, "TIME(timestamp) >= '%1'", this->start_time);
-	this->_append_sql_expression(expression, "TIME(timestamp) < '%1'", this->end_time);
+	if (!this->start_date.empty())
+		this->_append_sql_expression(expression, "timestamp >= %1", this->_start_timestamp);
+
+	if (!this->end_date.empty())
+		this->_append_sql_expression(expression, "timestamp < %1", this->_end_timestamp);
+
+	if (!this->start_time.empty())
+		this->_append_sql_expression(expression, "time_of_day >= %1", this->_start_time_of_day);
+
+	if (!this->end_time.empty())
+		this->_append_sql_expression(expression, "time_of_day < %1", this->_end_time_of_day);
 
 	return expression;
 }
 
-void TimeRange::_append_sql_expression(Glib::ustring & expression, const Glib::ustring & parameter_template, const Glib::ustring & value) const
+void TimeRange::_append_sql_expression(Glib::ustring & expression, const Glib::ustring & parameter_template, gint64 value) const
 {
-	if (!value.empty())
-	{
-		if (!expression.empty())
-			expression += " AND ";
+	if (!expression.empty())
+		expression += " AND ";
 
-		expression += Glib::ustring::compose(parameter_template, value);
-	}
+	expression += Glib::ustring::compose(parameter_template, value);
+}
+
+gint64 TimeRange::_parse_date(const Glib::ustring & date)
+{
+	const std::string & value = date.raw();
+	return days_from_civil(atoi(value.substr(0, 4).c_str()), atoi(value.substr(5, 2).c_str()), atoi(value.substr(8, 2).c_str())) * 86400;
+}
+
+gint64 TimeRange::_parse_time(const Glib::ustring & time)
+{
+	const std::string & value = time.raw();
+	return atoi(value.substr(0, 2).c_str()) * 3600 + atoi(value.substr(3, 2).c_str()) * 60 + atoi(value.substr(6, 2).c_str());
 }
@@ -32,6 +32,7 @@ class TimeRange
 	public:
 		TimeRange(const Glib::ustring & start_date, const Glib::ustring & end_date, const Glib::ustring & start_time, const Glib::ustring & end_time);
 
+		bool contains(gint64 timestamp) const;
 		Glib::ustring get_sql_expression() const;
 
 		const Glib::ustring start_date;
@@ -41,7 +42,16 @@ class TimeRange
 		const Glib::ustring end_time;
 
 	private:
-		void _append_sql_expression(Glib::ustring & expression, const Glib::ustring & parameter_template, const Glib::ustring & value) const;
+		void _append_sql_expression(Glib::ustring & expression, const Glib::ustring & parameter_template, gint64 value) const;
+
+		static gint64 _parse_date(const Glib::ustring & date);
+		static gint64 _parse_time(const Glib::ustring & time);
+
+		const gint64 _start_timestamp;
+		const gint64 _end_timestamp;
+
+		const gint64 _start_time_of_day;
+		const gint64 _end_time_of_day;
 };
 
 #endif // CHATSTATS_TIME_RANGE_HH
@@ -22,16 +22,63 @@
 
 #include "user.hh"
 
-User::User(const Glib::ustring & nick, const Glib::ustring & user, const Glib::ustring & host) :
+static InternTable<User, UserHash> & _get_users()
+{
+	static InternTable<User, UserHash> users;
+	return users;
+}
+
+size_t UserHash::operator()(const User & user) const
+{
+	const guint64 hash = ((static_cast<guint64>(user.nick) * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15)) ^ user.user) * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15) ^ user.host;
+	return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+User::User(guint32 nick, guint32 user, guint32 host) :
 	nick(nick),
 	user(user),
 	host(host)
 { }
 
+guint32 User::intern(const User & user)
+{
+	return _get_users().intern(user);
+}
+
+guint32 User::intern(Cache & cache, const User & user)
+{
+	return cache.intern(_get_users(), user);
+}
+
+const User & User::get(guint32 id)
+{
+	return _get_users().get(id);
+}
+
+const std::string & User::get_nick() const
+{
+	return StringPool::get(this->nick);
+}
+
+const std::string & User::get_user() const
+{
+	return StringPool::get(this->user);
+}
+
+const std::string & User::get_host() const
+{
+	return StringPool::get(this->host);
+}
+
 Glib::ustring User::to_string() const
 {
-	if (this->user.empty() || this->host.empty())
-		return this->nick;
+	if (this->user == StringPool::EMPTY || this->host == StringPool::EMPTY)
+		return this->get_nick();
 	else
-		return Glib::ustring::compose("%1!%2@%3", this->nick, this->user, this->host);
+		return Glib::ustring::compose("%1!%2@%3", this->get_nick(), this->get_user(), this->get_host());
+}
+
+bool User::operator==(const User & other) const
+{
+	return this->nick == other.nick && this->user == other.user && this->host == other.host;
 }
@@ -23,18 +23,43 @@
 #ifndef CHATSTATS_USER_HH
 #define CHATSTATS_USER_HH
 
+#include <string>
+
+#include <glib.h>
 #include <glibmm/ustring.h>
 
+#include "string_pool.hh"
+
+class User;
+
+class UserHash
+{
+	public:
+		size_t operator()(const User & user) const;
+};
+
 class User
 {
 	public:
-		User(const Glib::ustring & nick, const Glib::ustring & user, const Glib::ustring & host);
+		typedef InternTable<User, UserHash>::Cache Cache;
+
+		User(guint32 nick, guint32 user, guint32 host);
+
+		static guint32 intern(const User & user);
+		static guint32 intern(Cache & cache, const User & user);
+		static const User & get(guint32 id);
+
+		const std::string & get_nick() const;
+		const std::string & get_user() const;
+		const std::string & get_host() const;
 
 		Glib::ustring to_string() const;
 
-		const Glib::ustring nick;
-		const Glib::ustring user;
-		const Glib::ustring host;
+		bool operator==(const User & other) const;
+
+		const guint32 nick;
+		const guint32 user;
+		const guint32 host;
 };
 
 #endif // CHATSTATS_USER_HH
@@ -20,6 +20,10 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+
+#include <glibmm/regex.h>
+
 #include "user_specification.hh"
 #include "util.hh"
 
@@ -30,7 +34,7 @@ UserSpecification::UserSpecification(const Glib::ustring & alias) :
 NickSpecification::NickSpecification(const Glib::ustring & specification) :
 	specification(specification)
 {
-	auto match_regex = Glib::Regex::create("(?P<nick>[^!#]*)(!(?P<userhost>[^@]*@[^#]*))?(#(?P<start_date>[0-9]{4}-[0-9]{2}-[0-9]{2})?/(?P<end_date>[0-9]{4}-[0-9]{2}-[0-9]{2})?\\+(?P<start_time>[0-9]{2}:[0-9]{2}:[0-9]{2})?/(?P<end_time>[0-9]{2}:[0-9]{2}:[0-9]{2})?)?");
+	static const Glib::RefPtr<Glib::Regex> match_regex = Glib::Regex::create("(?P<nick>[^!#]*)(!(?P<userhost>[^@]*@[^#]*))?(#(?P<start_date>[0-9]{4}-[0-9]{2}-[0-9]{2})?/(?P<end_date>[0-9]{4}-[0-9]{2}-[0-9]{2})?\\+(?P<start_time>[0-9]{2}:[0-9]{2}:[0-9]{2})?/(?P<end_time>[0-9]{2}:[0-9]{2}:[0-9]{2})?)?");
 
 	Glib::MatchInfo match_info;
 
@@ -52,14 +56,17 @@ NickSpecification::NickSpecification(const Glib::ustring & specification) :
 
 			this->time_range = std::make_shared<TimeRange>(start_date, end_date, start_time, end_time);
 		}
+	}
 
-		Glib::ustring regex_string = Glib::ustring::compose("^%1$", Glib::Regex::escape_string(this->nickuserhost_specification));
-
-		string_replace(regex_string, "\\*", ".*");
-		string_replace(regex_string, "\\?", ".?");
+	this->_compute_specificity();
+}
 
-		this->regex = Glib::Regex::create(regex_string);
-	}
+NickSpecification::NickSpecification(const Glib::ustring & specification, const Glib::ustring & nickuserhost_specification, const std::shared_ptr<const TimeRange> & time_range) :
+	specification(specification),
+	nickuserhost_specification(nickuserhost_specification),
+	time_range(time_range)
+{
+	this->_compute_specificity();
 }
 
 Glib::ustring NickSpecification::get_like_expression() const
@@ -74,3 +81,13 @@ Glib::ustring NickSpecification::get_like_expression() const
 
 	return expression;
 }
+
+void NickSpecification::_compute_specificity()
+{
+	const std::string & value = this->nickuserhost_specification.raw();
+
+	const int stars = std::count(value.begin(), value.end(), '*');
+	const int questions = std::count(value.begin(), value.end(), '?');
+
+	this->specificity = std::make_tuple(stars + questions - static_cast<int>(this->nickuserhost_specification.length()), stars, questions);
+}
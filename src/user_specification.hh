@@ -24,9 +24,9 @@
 #define CHATSTATS_USER_SPECIFICATION_HH
 
 #include <memory>
+#include <tuple>
 #include <vector>
 
-#include <glibmm/regex.h>
 #include <glibmm/ustring.h>
 
 #include "time_range.hh"
@@ -35,17 +35,19 @@ class NickSpecification
 {
 	public:
 		NickSpecification(const Glib::ustring & specification);
+		NickSpecification(const Glib::ustring & specification, const Glib::ustring & nickuserhost_specification, const std::shared_ptr<const TimeRange> & time_range);
 
 		Glib::ustring get_like_expression() const;
 
-		Glib::RefPtr<Glib::Regex> regex;
-
 		const Glib::ustring specification;
 		Glib::ustring nickuserhost_specification;
 
 		std::shared_ptr<const TimeRange> time_range;
 
+		std::tuple<int, int, int> specificity;
 
+	private:
+		void _compute_specificity();
 };
 
 class UserSpecification
@@ -54,7 +54,44 @@ void string_replace(Glib::ustring & string, const Glib::ustring & search, const
 	}
 }
 
+std::vector<std::string> split_whitespace(const std::string & string)
+{
+	std::vector<std::string> tokens;
+	size_t start = 0;
+
+	while (true)
+	{
+		const size_t end = string.find_first_of("\t ", start);
+		tokens.push_back(string.substr(start, end - start));
+
+		if (end == std::string::npos)
+			break;
+
+		start = string.find_first_not_of("\t ", end);
+
+		if (start == std::string::npos)
+		{
+			tokens.push_back("");
+			break;
+		}
+	}
+
+	return tokens;
+}
+
 Glib::ustring urlify(const Glib::ustring & string)
 {
 	return Glib::Regex::create("[[:^alnum:]]+")->replace_literal(string, 0, "_", static_cast<Glib::RegexMatchFlags>(0));
 }
+
+gint64 days_from_civil(int year, int month, int day)
+{
+	year -= month <= 2;
+
+	const int era = (year >= 0 ? year : year - 399) / 400;
+	const int year_of_era = year - era * 400;
+	const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+	return static_cast<gint64>(era) * 146097 + day_of_era - 719468;
+}
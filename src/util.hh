@@ -23,6 +23,10 @@
 #ifndef CHATSTATS_UTIL_HH
 #define CHATSTATS_UTIL_HH
 
+#include <string>
+#include <vector>
+
+#include <glib.h>
 #include <glibmm/regex.h>
 #include <glibmm/ustring.h>
 
@@ -30,6 +34,9 @@ void encode_character(Glib::ustring & string, char search, const Glib::ustring &
 Glib::ustring encode_html_characters(Glib::ustring string);
 
 void string_replace(Glib::ustring & string, const Glib::ustring & search, const Glib::ustring & replace);
+std::vector<std::string> split_whitespace(const std::string & string);
 Glib::ustring urlify(const Glib::ustring & string);
 
+gint64 days_from_civil(int year, int month, int day);
+
 #endif // CHATSTATS_UTIL_HH
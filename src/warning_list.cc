@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+
+#include "warning_list.hh"
+
+Warning::Warning(int line, WarningType type, const Glib::ustring & detail) :
+	line(line),
+	type(type),
+	detail(detail)
+{ }
+
+Glib::ustring Warning::to_string() const
+{
+	if (this->detail.empty())
+		return WarningList::get_description(this->type);
+
+	return Glib::ustring::compose("%1: %2", WarningList::get_description(this->type), this->detail);
+}
+
+const guint64 WarningList::SAMPLE_LIMIT = 10;
+
+Glib::ustring WarningList::get_description(WarningType type)
+{
+	switch (type)
+	{
+		case WarningType::EMPTY_OBJECT_NICKNAME:
+			return "Empty object nickname";
+		case WarningType::EMPTY_SUBJECT_NICKNAME:
+			return "Empty subject nickname";
+		case WarningType::INVALID_MONTH_NAME:
+			return "Invalid month name in timestamp";
+		case WarningType::INVALID_TIMESTAMP:
+			return "Invalid or missing timestamp";
+		case WarningType::MULTIPLE_SESSION_TARGETS:
+			return "Multiple session targets defined";
+		case WarningType::NO_SESSION_TARGET:
+			return "No session target in file";
+		case WarningType::PARTIAL_TIMESTAMP:
+			return "Partial timestamp used before complete timestamp";
+		case WarningType::TIMESTAMP_BACKWARDS:
+			return "Timestamp is earlier than the previous timestamp";
+		case WarningType::UNRECOGNIZED_LINE:
+			return "Unrecognized line";
+		default:
+			return "Unknown warning";
+	}
+}
+
+WarningList::WarningList()
+{
+	this->clear();
+}
+
+void WarningList::add_unsampled(WarningType type, guint64 count)
+{
+	this->_counts[static_cast<size_t>(type)] += count;
+}
+
+void WarningList::merge(const WarningList & other, int line_offset)
+{
+	std::array<guint64, static_cast<size_t>(WarningType::COUNT)> sampled;
+
+	for (size_t i = 0; i < sampled.size(); i++)
+		sampled[i] = std::min(this->_counts[i], WarningList::SAMPLE_LIMIT);
+
+	for (const Warning & warning : other._samples)
+	{
+		if (sampled[static_cast<size_t>(warning.type)]++ < WarningList::SAMPLE_LIMIT)
+			this->_add_sample(Warning(warning.line + line_offset, warning.type, warning.detail));
+	}
+
+	for (size_t i = 0; i < this->_counts.size(); i++)
+		this->_counts[i] += other._counts[i];
+}
+
+void WarningList::clear()
+{
+	this->_counts.fill(0);
+	this->_samples.clear();
+}
+
+bool WarningList::empty() const
+{
+	return std::all_of(this->_counts.begin(), this->_counts.end(), [](guint64 count) { return count == 0; });
+}
+
+guint64 WarningList::get_count(WarningType type) const
+{
+	return this->_counts[static_cast<size_t>(type)];
+}
+
+const std::vector<Warning> & WarningList::get_samples() const
+{
+	return this->_samples;
+}
+
+void WarningList::_add_sample(const Warning & warning)
+{
+	this->_samples.insert(std::upper_bound(this->_samples.begin(), this->_samples.end(), warning, [](const Warning & a, const Warning & b) { return a.line < b.line; }), warning);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2012 Jason Lynch <jason@calindora.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHATSTATS_WARNING_LIST_HH
+#define CHATSTATS_WARNING_LIST_HH
+
+#include <array>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/ustring.h>
+
+enum class WarningMode
+{
+	FULL,
+	SUMMARY,
+	NONE
+};
+
+enum class WarningType : guint8
+{
+	EMPTY_OBJECT_NICKNAME,
+	EMPTY_SUBJECT_NICKNAME,
+	INVALID_MONTH_NAME,
+	INVALID_TIMESTAMP,
+	MULTIPLE_SESSION_TARGETS,
+	NO_SESSION_TARGET,
+	PARTIAL_TIMESTAMP,
+	TIMESTAMP_BACKWARDS,
+	UNRECOGNIZED_LINE,
+	COUNT
+};
+
+class Warning
+{
+	public:
+		Warning(int line, WarningType type, const Glib::ustring & detail);
+
+		Glib::ustring to_string() const;
+
+		int line;
+		WarningType type;
+		Glib::ustring detail;
+};
+
+class WarningList
+{
+	public:
+		const static guint64 SAMPLE_LIMIT;
+
+		static Glib::ustring get_description(WarningType type);
+
+		WarningList();
+
+		void add(int line, WarningType type)
+		{
+			if (++this->_counts[static_cast<size_t>(type)] <= WarningList::SAMPLE_LIMIT)
+				this->_add_sample(Warning(line, type, ""));
+		}
+
+		void add(int line, WarningType type, const char * detail_begin, const char * detail_end)
+		{
+			if (++this->_counts[static_cast<size_t>(type)] <= WarningList::SAMPLE_LIMIT)
+				this->_add_sample(Warning(line, type, Glib::ustring(detail_begin, detail_end)));
+		}
+
+		void add_unsampled(WarningType type, guint64 count);
+		void merge(const WarningList & other, int line_offset);
+		void clear();
+
+		bool empty() const;
+		guint64 get_count(WarningType type) const;
+		const std::vector<Warning> & get_samples() const;
+
+	private:
+		void _add_sample(const Warning & warning);
+
+		std::array<guint64, static_cast<size_t>(WarningType::COUNT)> _counts;
+		std::vector<Warning> _samples;
+};
+
+#endif // CHATSTATS_WARNING_LIST_HH